@@ -10,15 +10,20 @@
 #include <standalone/AdsDef.h>
 #endif /* USE_TC_ADS */
 #include <Connection.h>
+#include <SymbolTable.h>
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <Types.h>
 #include <err.h>
-#include <epicsString.h>
+#include <alarm.h>
 #include <ADSPortDriver.h>
 #include <stdexcept>
 #include <thread>
@@ -31,7 +36,16 @@ bool ADSDeviceAddress::operator==(DeviceAddress const &other) const {
            address.get_data_type() == b.address.get_data_type() &&
            address.get_ads_port() == b.address.get_ads_port() &&
            address.get_nelem() == b.address.get_nelem() &&
-           address.get_operation() == b.address.get_operation();
+           address.get_operation() == b.address.get_operation() &&
+           address.get_notification_delay() ==
+               b.address.get_notification_delay() &&
+           address.get_scan_class() == b.address.get_scan_class() &&
+           address.has_element_offset() == b.address.has_element_offset() &&
+           address.get_element_offset() == b.address.get_element_offset() &&
+           address.has_deadband() == b.address.has_deadband() &&
+           address.get_deadband() == b.address.get_deadband() &&
+           address.get_relative_deadband() ==
+               b.address.get_relative_deadband();
 }
 
 ADSDeviceAddress::ADSDeviceAddress(std::string const &func,
@@ -60,6 +74,20 @@ DeviceAddress *ADSPortDriver::parseDeviceAddress(std::string const &function,
     return adsDeviceAddr;
 }
 
+// records reading the same symbol with the same data type, number of elements
+// and scan class read the same data, e.g. INT and INT_digi
+static std::string sharedVariableKey(ADSAddress const &addr) {
+    std::ostringstream key;
+    key << addr.get_ads_port() << " "
+        << boost::algorithm::to_lower_copy(addr.get_var_name()) << " "
+        << static_cast<int>(addr.get_data_type()) << " " << addr.get_nelem()
+        << " " << addr.get_scan_class();
+    if (addr.has_element_offset()) {
+        key << " " << addr.get_element_offset();
+    }
+    return key.str();
+}
+
 ADSDeviceVar::ADSDeviceVar(DeviceVariable *baseInfo, ADSPortDriver *driver)
     : DeviceVariable(baseInfo), driver(driver),
       adsPV(new ADSVariable(std::make_shared<ADSAddress>(
@@ -77,10 +105,51 @@ DeviceVariable *ADSPortDriver::createDeviceVariable(DeviceVariable *baseInfo) {
 
     adsDeviceVar->adsPV->set_connection(adsConnection);
 
-    if (adsDeviceVar->adsPV->addr->get_operation() == Operation::Read) {
-        ads_read_vars.push_back(adsDeviceVar->adsPV);
+    // elements are read from their parent variable in the sum-read
+    if (adsDeviceVar->adsPV->addr->has_element_offset() &&
+        (adsDeviceVar->adsPV->addr->get_operation() != Operation::Read ||
+         adsDeviceVar->adsPV->uses_notification())) {
+        LOG_ERR("%s: ERROR, OFFS= is only supported for sum-read variables: "
+                "'%s'\n",
+                __FUNCTION__, adsDeviceVar->adsPV->addr->info().c_str());
+        delete adsDeviceVar;
+        return nullptr;
+    }
+
+    // deadbands filter I/O Intr updates of analog values
+    auto dataType = adsDeviceVar->adsPV->addr->get_data_type();
+    if (adsDeviceVar->adsPV->addr->has_deadband() &&
+        (adsDeviceVar->adsPV->addr->get_operation() != Operation::Read ||
+         (dataType != ADSDataType::REAL && dataType != ADSDataType::LREAL) ||
+         adsDeviceVar->function().find("[]") != std::string::npos)) {
+        LOG_ERR("%s: ERROR, DB= and RDB= are only supported for REAL and "
+                "LREAL read variables: '%s'\n",
+                __FUNCTION__, adsDeviceVar->adsPV->addr->info().c_str());
+        delete adsDeviceVar;
+        return nullptr;
+    }
+
+    if (adsDeviceVar->adsPV->uses_notification()) {
+        ads_notify_vars.push_back(adsDeviceVar->adsPV);
+    } else if (adsDeviceVar->adsPV->addr->get_operation() == Operation::Read) {
+        // the symbol is resolved and sum-read once for all records reading it
+        std::string key = sharedVariableKey(*adsDeviceVar->adsPV->addr);
+        auto shared = sharedReadVars.find(key);
+        if (shared != sharedReadVars.end()) {
+            adsDeviceVar->adsPV = shared->second;
+            sharedReadUsers++;
+        } else if (adsDeviceVar->adsPV->addr->has_element_offset() ||
+                   (foldElementsEnabled &&
+                    !adsDeviceVar->adsPV->addr->get_parent_name().empty())) {
+            sharedReadVars[key] = adsDeviceVar->adsPV;
+            addElementVariable(adsDeviceVar->adsPV);
+        } else {
+            sharedReadVars[key] = adsDeviceVar->adsPV;
+            ads_read_vars.push_back(adsDeviceVar->adsPV);
+        }
     } else if (adsDeviceVar->adsPV->addr->get_operation() == Operation::Write) {
         ads_write_vars.push_back(adsDeviceVar->adsPV);
+        writeDeviceVars[adsDeviceVar->adsPV.get()] = adsDeviceVar;
     }
 
     // caller of this function is the owner of the returned pointer
@@ -90,7 +159,8 @@ DeviceVariable *ADSPortDriver::createDeviceVariable(DeviceVariable *baseInfo) {
 ADSPortDriver::ADSPortDriver(
     char const *portName, char const *ipAddr, char const *amsNetId,
     uint16_t sumBufferSize = defaultSumBuferNelem,
-    uint32_t adsFunctionTimeout = defaultADSCallTimeout_ms, uint16_t deviceReadAdsPort = defaultDeviceReadADSPort , std::chrono::milliseconds sumReadPeriod = defaultSumReadPeriod)
+    uint32_t adsFunctionTimeout = defaultADSCallTimeout_ms, uint16_t deviceReadAdsPort = defaultDeviceReadADSPort , std::chrono::milliseconds sumReadPeriod = defaultSumReadPeriod,
+    uint16_t sumReadParallelism = defaultSumReadParallelism)
     : Autoparam::Driver(portName, Autoparam::DriverOpts()
                                       .setAutoInterrupts(false)
                                       .setAutoConnect(true)
@@ -98,9 +168,21 @@ ADSPortDriver::ADSPortDriver(
                                       .setInitHook(initHook)),
       portName(portName), ipAddr(ipAddr), amsNetId{0, 0, 0 ,0 ,0 ,0},
       sumBufferSize(sumBufferSize), adsFunctionTimeout(adsFunctionTimeout),
-      deviceReadAdsPort(deviceReadAdsPort), sumReadPeriod(sumReadPeriod),  adsConnection(new Connection()),
-      SumRead(sumBufferSize, adsConnection),
-      exitCalled(false), initialized(false),
+      deviceReadAdsPort(deviceReadAdsPort), sumReadPeriod(sumReadPeriod),
+      sumReadParallelism(sumReadParallelism), adsConnection(new Connection()),
+      deliveryThreadEnabled(false), deliveryRingDepth(defaultDeliveryRingDepth),
+      deliveryCarryPending(false), deliveredCycles(0), deliveryPasses(0),
+      deliveryOverflows(0), decodeWorkers(1), decodeNextChunk(0),
+      decodeRound(0), decodeBusy(0), decodePasses(0), parallelDecodePasses(0),
+      SumWrite(sumBufferSize, adsConnection), sumWriteEnabled(false),
+      overrunPolicy(OverrunPolicy::Skip),
+      exitCalled(false), scanWakeRequested(false),
+      deliveryWakeRequested(false), initialized(false),
+      sharedReadUsers(0), foldElementsEnabled(false),
+      arrayPosts(0), arrayPostsSkipped(0),
+      lastReportTime(std::chrono::steady_clock::now()), lastReportSkipped(0),
+      handlesKept(false), symbolTableEnabled(false),
+      mergeGap(-1), deadband(0), relativeDeadband(0), deadbandFiltered(0),
       currentDeviceState(ADSSTATE_INVALID) {
 
 #ifdef USE_TC_ADS
@@ -114,6 +196,9 @@ ADSPortDriver::ADSPortDriver(
     this->amsNetId = std::string(amsNetId);
 #endif
 
+    adsConnection->set_sum_operations_max_commands(sumBufferSize);
+    adsConnection->set_notification_listener([this]() { wakeScan(); });
+
     // scalars
     registerHandlers<epicsInt32>(ads_datatypes_str.at(ADSDataType::BOOL),
                                  integerRead<epicsInt8, epicsInt32>,
@@ -247,13 +332,17 @@ ADSPortDriver::ADSPortDriver(
 
 ADSPortDriver::~ADSPortDriver() {
     LOG_WARN_ASYN(pasynUserSelf, "Shutting down");
-    {
-        std::lock_guard<ADSPortDriver> guard(*this);
-        exitCalled = true;
-    }
+    signalExit();
 
     LOG_WARN_ASYN(pasynUserSelf, "Waiting for threads to join");
     adsScanThread.join();
+    if (deliveryThread.joinable()) {
+        deliveryThread.join();
+    }
+    for (auto itr = decodeThreads.begin(); itr != decodeThreads.end();
+         itr++) {
+        itr->join();
+    }
 
     LOG_WARN_ASYN(pasynUserSelf, "Shutdown complete");
 }
@@ -270,20 +359,40 @@ void ADSPortDriver::initHook(Autoparam::Driver *driver) {
         return;
     }
 
-    // add write variables with asyn:READBACK to the list of sum read variables
+    // add write variables with asyn:READBACK to the list of sum read variables,
+    // unless their symbol is already read by another record, and bind the
+    // decoders used to update I/O Intr variables
     auto vars = self->getInterruptVariables();
+    std::vector<IntrVariable> intrVars;
+    intrVars.reserve(vars.size());
     for (auto itr = vars.begin(); itr != vars.end(); itr++) {
         auto &adsVar = *static_cast<ADSDeviceVar *>(*itr);
         if (adsVar.adsPV->addr->get_operation() == Operation::Write) {
             adsVar.adsPV->set_write_readback(true);
-            self->ads_read_vars.push_back(adsVar.adsPV);
+            auto shared = self->sharedReadVars.find(
+                sharedVariableKey(*adsVar.adsPV->addr));
+            if (shared != self->sharedReadVars.end()) {
+                adsVar.adsPV->set_read_source(shared->second);
+                self->sharedReadUsers++;
+            } else {
+                self->ads_read_vars.push_back(adsVar.adsPV);
+            }
         }
+
+        IntrVariable intrVar = selectDecoder(adsVar);
+        if (intrVar.decode == nullptr) {
+            LOG_ERR_ASYN(self->pasynUserSelf,
+                         "No decoder for I/O Intr variable '%s'",
+                         adsVar.adsPV->addr->info().c_str());
+            continue;
+        }
+        intrVars.push_back(intrVar);
     }
 
     {
         std::lock_guard<ADSPortDriver> guard(*self);
 
-        auto status = self->SumRead.allocate(self->ads_read_vars);
+        auto status = self->allocateScanClasses();
         if (status) {
             LOG_ERR_ASYN(self->pasynUserSelf,
                          "Error allocating sum-read request buffers (%i): %s",
@@ -293,11 +402,39 @@ void ADSPortDriver::initHook(Autoparam::Driver *driver) {
 
         LOG_TRACE_ASYN(
             self->pasynUserSelf,
-            "Successfully allocated sum-read request buffers for %lu variables",
-            self->ads_read_vars.size());
+            "Successfully allocated sum-read request buffers for %lu variables"
+            " in %lu scan classes",
+            self->ads_read_vars.size(), self->scanClasses.size());
+
+        // I/O Intr variables are decoded after their scan class is read
+        for (auto itr = intrVars.begin(); itr != intrVars.end(); itr++) {
+            std::shared_ptr<ADSVariable> adsPV = itr->var->adsPV;
+            if (adsPV->uses_notification()) {
+                self->notifyIntrVars.push_back(*itr);
+                continue;
+            }
+
+            for (auto cls = self->scanClasses.begin();
+                 cls != self->scanClasses.end(); cls++) {
+                if (cls->id == adsPV->addr->get_scan_class()) {
+                    cls->intrVars.push_back(*itr);
+                    break;
+                }
+            }
+        }
+
+        self->decodeQueue.reserve(intrVars.size());
+        if (self->decodeWorkers > 1) {
+            self->startDecodeWorkers();
+        }
+        if (self->deliveryThreadEnabled) {
+            self->startDelivery();
+        }
 
         self->initialized = true;
     }
+
+    self->wakeScan();
 }
 
 asynStatus ADSPortDriver::ADSConnect(asynUser *pasynUser) {
@@ -318,7 +455,8 @@ asynStatus ADSPortDriver::ADSConnect(asynUser *pasynUser) {
     }
 
     // connect to the ADS device
-    status = static_cast<asynStatus>(adsConnection->connect(amsNetId, ipAddr, deviceReadAdsPort));
+    status = static_cast<asynStatus>(adsConnection->connect(amsNetId, ipAddr, deviceReadAdsPort,
+                                sumReadParallelism));
 
     if (status) {
         LOG_ERR_ASYN(pasynUser, "Could not connect to ADS device (%i): %s",
@@ -328,6 +466,18 @@ asynStatus ADSPortDriver::ADSConnect(asynUser *pasynUser) {
     LOG_WARN_ASYN(pasynUser, "Connected to ADS device (IP: %s)",
                   ipAddr.c_str());
 
+    // handles kept from a lost connection are only reused if the symbols of
+    // their ADS port haven't changed
+    checkSymbolVersions(pasynUser);
+
+    if (elementParents.size()) {
+        locateElements(pasynUser);
+    }
+
+    if (symbolTableEnabled) {
+        resolveFromSymbolTables(pasynUser);
+    }
+
     // resolving means translating symbolic names to actual addresses
     // it is done separately for read and write vars
     LOG_WARN_ASYN(pasynUser, "Resolving ADS variable names");
@@ -360,31 +510,92 @@ asynStatus ADSPortDriver::ADSConnect(asynUser *pasynUser) {
     LOG_WARN_ASYN(pasynUser, "Resolved %lu read and %lu write variable names",
                   ads_read_vars.size(), ads_write_vars.size());
 
+    // variables with notifications are left out of the sum-read
+    if (ads_notify_vars.size()) {
+        status = static_cast<asynStatus>(
+            adsConnection->resolve_variables(ads_notify_vars));
+        if (status == asynSuccess) {
+            status = static_cast<asynStatus>(
+                adsConnection->add_notifications(ads_notify_vars));
+        }
+
+        if (status) {
+            LOG_ERR_ASYN(pasynUser,
+                         "Could not add ADS device notifications (%i): %s",
+                         status, ads_errors[status].c_str());
+            return status;
+        }
+        LOG_WARN_ASYN(pasynUser, "Added %lu ADS device notifications",
+                      ads_notify_vars.size());
+    }
+
     // initialize sum-read buffers
-    status = static_cast<asynStatus>(SumRead.initialize());
-    if (status) {
-        LOG_ERR_ASYN(pasynUser,
-                     "Error initializing sum-read request buffers (%i): %s",
-                     status, ads_errors[status].c_str());
-        return status;
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        cls->sumRead->set_merge_gap(mergeGap);
+        status = static_cast<asynStatus>(cls->sumRead->initialize());
+        if (status) {
+            LOG_ERR_ASYN(pasynUser,
+                         "Error initializing sum-read request buffers (%i): %s",
+                         status, ads_errors[status].c_str());
+            return status;
+        }
     }
 
     LOG_WARN_ASYN(pasynUser, "Initialized sum-read request buffers");
 
-    status = doSumRead();
+    status = asynSuccess;
+    auto timeNow = std::chrono::steady_clock::now();
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        status = doSumRead(*cls);
+        if (status) {
+            break;
+        }
+        cls->nextRead = timeNow + cls->period;
+        cls->decodePending = true;
+    }
     LOG_WARN_ASYN(pasynUser, "Inital sum-read status (%i): %s", status,
                   ads_errors[status].c_str());
 
     return status;
 }
 
-asynStatus ADSPortDriver::ADSDisconnect(asynUser *pasynUser) {
+asynStatus ADSPortDriver::ADSDisconnect(asynUser *pasynUser,
+                                        bool keepHandles) {
     LOG_TRACE_ASYN(pasynUser, "Entering");
-    SumRead.deinitialize();
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        cls->sumRead->deinitialize();
+    }
+
+    // queued writes can't be sent anymore
+    SumWrite.discard(EPICSADS_DISCONNECTED, writeResults);
+    if (!exitCalled) {
+        postWriteResults();
+    } else {
+        writeResults.clear();
+    }
 
     // If exitCalled is true, it means the driver is shutting down
     // so unresolving variables doesn't make sense
+    if (!exitCalled && keepHandles) {
+        LOG_WARN_ASYN(pasynUser, "Disconnecting, keeping ADS variable handles");
+        adsConnection->disconnect(true);
+        adsConnection->set_disconnected();
+
+        // the connection is down, so notifications are only forgotten
+        adsConnection->delete_notifications(ads_notify_vars);
+
+        // handles don't survive a runtime that already left RUN
+        if (adsConnection->is_connected() == false &&
+            currentAdsState == ADSState::Run) {
+            handlesKept = true;
+        }
+        return asynSuccess;
+    }
+
     if (!exitCalled) {
+        // notifications are forgotten even if the connection is already lost
+        adsConnection->delete_notifications(ads_notify_vars);
+
         if (adsConnection->is_connected() == false) {
             LOG_WARN_ASYN(pasynUser, "Already disconnected");
             return asynSuccess;
@@ -393,6 +604,7 @@ asynStatus ADSPortDriver::ADSDisconnect(asynUser *pasynUser) {
         LOG_TRACE_ASYN(pasynUser, "Unresolving ADS read variables");
         adsConnection->unresolve_variables(ads_read_vars);
         adsConnection->unresolve_variables(ads_write_vars);
+        adsConnection->unresolve_variables(ads_notify_vars);
     }
 
     LOG_TRACE_ASYN(pasynUser, "Disconnecting from ADS device");
@@ -414,23 +626,29 @@ void ADSPortDriver::adsScan() {
         // get ADS connection status
         bool adsConnected = adsConnection->is_connected();
 
+        // nothing to do until iocInit calls initHook
         if (!initialized) {
+            std::unique_lock<std::mutex> lock(scanMtx);
+            scanCondition.wait(lock,
+                               [this] { return initialized || exitCalled; });
             continue;
         }
 
-        if (!adsConnected || !SumRead.is_initialized() ||
-            !SumRead.is_allocated()) {
+        if (!adsConnected || !scanClassesInitialized()) {
 
             {
                 std::lock_guard<ADSPortDriver> guard(*this);
 
                 auto status = ADSConnect(pasynUserSelf);
                 if (status) {
-                    ADSDisconnect(pasynUserSelf);
+                    ADSDisconnect(pasynUserSelf, true);
                 }
             }
 
-            std::this_thread::sleep_for(waitForConnectionPeriod);
+            // only shutdown interrupts waiting for the connection
+            std::unique_lock<std::mutex> lock(scanMtx);
+            scanCondition.wait_for(lock, waitForConnectionPeriod,
+                                   [this] { return exitCalled.load(); });
             continue;
         }
 
@@ -445,21 +663,56 @@ void ADSPortDriver::adsScan() {
             if (readADSDeviceState()) {
                 continue;
             }
+            if (checkSymbolsChanged()) {
+                continue;
+            }
 
             lastADSUpdate = timeNow;
         }
 
-        // perform sum-read and trigger callbacks for I/O intr records
-        if (doSumRead()) {
+        // send writes queued since the previous cycle
+        flushWrites();
+
+        // perform sum-reads of the scan classes that are due and trigger
+        // callbacks for I/O intr records; the loop runs at least every
+        // sumReadPeriod to flush writes and deliver notifications
+        std::set<uint32_t> readRequests;
+        {
+            std::lock_guard<std::mutex> lock(scanMtx);
+            readRequests.swap(scanReadRequests);
+        }
+
+        timeNow = std::chrono::steady_clock::now();
+        auto wakeUp = timeNow + this->sumReadPeriod;
+        bool readFailed = false;
+        for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+            bool due = cls->nextRead <= timeNow;
+            if (due || readRequests.count(cls->id) != 0) {
+                auto readStart = std::chrono::steady_clock::now();
+                if (doSumRead(*cls)) {
+                    readFailed = true;
+                    break;
+                }
+                // requested reads don't move the schedule
+                if (due) {
+                    scheduleNextRead(*cls, readStart);
+                }
+                cls->decodePending = true;
+            }
+            wakeUp = std::min(wakeUp, cls->nextRead);
+        }
+        if (readFailed) {
             continue;
         }
 
-        {
+        if (deliveryRing) {
+            handOffCycle();
+        } else {
             std::lock_guard<ADSPortDriver> guard(*this);
             performIOIntr();
         }
 
-        std::this_thread::sleep_for(this->sumReadPeriod);
+        waitScan(wakeUp);
     }
 
     LOG_TRACE_ASYN(pasynUserSelf, "ADS scan thread exiting");
@@ -470,6 +723,170 @@ void ADSPortDriver::adsScan() {
     }
 }
 
+void ADSPortDriver::signalExit() {
+    {
+        std::lock_guard<ADSPortDriver> guard(*this);
+        exitCalled = true;
+    }
+
+    wakeScan();
+
+    {
+        std::lock_guard<std::mutex> lock(deliveryMtx);
+        deliveryCondition.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(decodeMtx);
+    decodeCondition.notify_all();
+}
+
+void ADSPortDriver::startDelivery() {
+    DeliveryCycle empty;
+    empty.classRead.assign(scanClasses.size(), 0);
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        empty.updated.emplace_back(cls->intrVars.size(), 0);
+    }
+
+    // all slots are sized here, so handing over a cycle doesn't allocate
+    deliveryCarry = empty;
+    deliveryRing.reset(new SpscRing<DeliveryCycle>(deliveryRingDepth, empty));
+    deliveryThread = std::thread(&ADSPortDriver::adsDeliver, this);
+}
+
+void ADSPortDriver::handOffCycle() {
+    // the updated flags are taken from the sum-read buffers here, as the scan
+    // thread overwrites them with the next read
+    bool anyRead = false;
+    for (size_t i = 0; i < scanClasses.size(); i++) {
+        ScanClass &cls = scanClasses[i];
+        if (!cls.decodePending) {
+            continue;
+        }
+        cls.decodePending = false;
+        anyRead = true;
+
+        deliveryCarry.classRead[i] = 1;
+        std::vector<uint8_t> &updated = deliveryCarry.updated[i];
+        for (size_t v = 0; v < cls.intrVars.size(); v++) {
+            if (cls.intrVars[v].var->adsPV->is_read_updated()) {
+                updated[v] = 1;
+            }
+        }
+    }
+
+    // notifications are decoded by the delivery thread in every cycle
+    if (!anyRead && !deliveryCarryPending && notifyIntrVars.empty()) {
+        return;
+    }
+
+    // when the delivery thread falls behind, the cycle is merged into the
+    // next one; the data is always decoded from the newest sum-read
+    DeliveryCycle *slot = deliveryRing->producer_slot();
+    if (slot == nullptr) {
+        deliveryOverflows++;
+        deliveryCarryPending = true;
+    } else {
+        slot->classRead.swap(deliveryCarry.classRead);
+        slot->updated.swap(deliveryCarry.updated);
+        std::fill(deliveryCarry.classRead.begin(),
+                  deliveryCarry.classRead.end(), 0);
+        for (auto itr = deliveryCarry.updated.begin();
+             itr != deliveryCarry.updated.end(); itr++) {
+            std::fill(itr->begin(), itr->end(), 0);
+        }
+        deliveryRing->push();
+        deliveryCarryPending = false;
+    }
+
+    std::lock_guard<std::mutex> lock(deliveryMtx);
+    deliveryWakeRequested = true;
+    deliveryCondition.notify_one();
+}
+
+void ADSPortDriver::deliverCycle(DeliveryCycle &cycle) {
+    for (size_t i = 0; i < scanClasses.size(); i++) {
+        if (cycle.classRead[i]) {
+            queueUpdated(scanClasses[i].intrVars, &cycle.updated[i]);
+        }
+    }
+    queueUpdated(notifyIntrVars);
+
+    if (decodeQueued()) {
+        callParamCallbacks();
+    }
+}
+
+void ADSPortDriver::adsDeliver() {
+    LOG_TRACE_ASYN(pasynUserSelf, "ADS delivery thread starting");
+
+    DeliveryCycle merged = deliveryCarry;
+    while (!exitCalled) {
+        {
+            std::unique_lock<std::mutex> lock(deliveryMtx);
+            deliveryCondition.wait(lock, [this] {
+                return deliveryWakeRequested || exitCalled;
+            });
+            deliveryWakeRequested = false;
+        }
+
+        // the newest data wins: all queued cycles are merged and decoded
+        // once
+        uint64_t taken = 0;
+        DeliveryCycle *slot;
+        while ((slot = deliveryRing->consumer_slot()) != nullptr) {
+            for (size_t i = 0; i < merged.classRead.size(); i++) {
+                merged.classRead[i] |= slot->classRead[i];
+                for (size_t v = 0; v < merged.updated[i].size(); v++) {
+                    merged.updated[i][v] |= slot->updated[i][v];
+                }
+            }
+            deliveryRing->pop();
+            taken++;
+        }
+        if (taken == 0) {
+            continue;
+        }
+        deliveredCycles += taken;
+        deliveryPasses++;
+
+        {
+            std::lock_guard<ADSPortDriver> guard(*this);
+            if (exitCalled) {
+                break;
+            }
+            deliverCycle(merged);
+        }
+
+        std::fill(merged.classRead.begin(), merged.classRead.end(), 0);
+        for (auto itr = merged.updated.begin(); itr != merged.updated.end();
+             itr++) {
+            std::fill(itr->begin(), itr->end(), 0);
+        }
+    }
+
+    LOG_TRACE_ASYN(pasynUserSelf, "ADS delivery thread exiting");
+}
+
+void ADSPortDriver::wakeScan() {
+    std::lock_guard<std::mutex> lock(scanMtx);
+    scanWakeRequested = true;
+    scanCondition.notify_one();
+}
+
+void ADSPortDriver::requestRead(uint32_t scanClass) {
+    std::lock_guard<std::mutex> lock(scanMtx);
+    scanReadRequests.insert(scanClass);
+    scanWakeRequested = true;
+    scanCondition.notify_one();
+}
+
+void ADSPortDriver::waitScan(std::chrono::steady_clock::time_point until) {
+    std::unique_lock<std::mutex> lock(scanMtx);
+    scanCondition.wait_until(
+        lock, until, [this] { return scanWakeRequested || exitCalled; });
+    scanWakeRequested = false;
+}
+
 asynStatus ADSPortDriver::readADSDeviceInfo() {
     char info[16];
     AdsVersion version;
@@ -479,7 +896,7 @@ asynStatus ADSPortDriver::readADSDeviceInfo() {
 
     if (status) {
         LOG_WARN_ASYN(pasynUserSelf, "Cannot read ADS device info");
-        ADSDisconnect(pasynUserSelf);
+        ADSDisconnect(pasynUserSelf, true);
         return status;
     }
 
@@ -497,7 +914,7 @@ asynStatus ADSPortDriver::readADSDeviceState() {
 
     if (status) {
         LOG_WARN_ASYN(pasynUserSelf, "Cannot read ADS device state");
-        ADSDisconnect(pasynUserSelf);
+        ADSDisconnect(pasynUserSelf, true);
         return status;
     }
     currentAdsState = state;
@@ -505,239 +922,1075 @@ asynStatus ADSPortDriver::readADSDeviceState() {
     return status;
 }
 
-asynStatus ADSPortDriver::doSumRead() {
-    asynStatus status = static_cast<asynStatus>(SumRead.read());
+asynStatus ADSPortDriver::checkSymbolsChanged() {
+    // variables resolved from the symbol table or located within their
+    // parent read raw index group/offset addresses, which an online change
+    // can move to other data
+    for (auto itr = symbolVersions.begin(); itr != symbolVersions.end();
+         itr++) {
+        uint8_t version;
+        if (adsConnection->read_symbol_version(itr->first, &version) != 0 ||
+            version == itr->second) {
+            continue;
+        }
 
-    if (status) {
-        LOG_WARN_ASYN(pasynUserSelf, "Cannot perform sum-read");
+        LOG_WARN_ASYN(pasynUserSelf,
+                      "Symbols of ADS port %u changed (version %u -> %u), "
+                      "resolving variables again",
+                      itr->first, itr->second, version);
+
+        std::lock_guard<ADSPortDriver> guard(*this);
         ADSDisconnect(pasynUserSelf);
+        return asynError;
     }
 
-    return status;
+    return asynSuccess;
 }
 
-template <typename PLCDataType, typename epicsDataType>
-void ADSPortDriver::performArrayCallbacks(ADSDeviceVar &parentDeviceVar,
-                                          unsigned int const &nelem) {
-
-    std::vector<epicsDataType> buffer(nelem);
-    Autoparam::Array<epicsDataType> readArray(buffer.data(), buffer.size());
-
-    ArrayReadResult result = arrayRead<PLCDataType, epicsDataType>(parentDeviceVar, readArray);
-    int hash = epicsMemHash(reinterpret_cast<char const *>(readArray.data()), readArray.size() * sizeof(epicsDataType), 0);
-
-    // Mimic the behavior of callParamCallbacks() by only doing the callbacks if data has changed.
-    if (parentDeviceVar.adsPV->updateDataHash(hash)) {
-        doCallbacksArray(parentDeviceVar, readArray, result.status,
-                        result.alarmStatus, result.alarmSeverity);
-    }
+std::vector<std::shared_ptr<ADSVariable>> ADSPortDriver::allVariables() {
+    std::vector<std::shared_ptr<ADSVariable>> vars;
+    vars.insert(vars.end(), ads_read_vars.begin(), ads_read_vars.end());
+    vars.insert(vars.end(), ads_write_vars.begin(), ads_write_vars.end());
+    vars.insert(vars.end(), ads_notify_vars.begin(), ads_notify_vars.end());
+    return vars;
 }
 
-void ADSPortDriver::performIOIntr() {
-
-    auto vars = getInterruptVariables();
+void ADSPortDriver::checkSymbolVersions(asynUser *pasynUser) {
+    std::vector<std::shared_ptr<ADSVariable>> vars = allVariables();
 
+    // ports without a readable symbol version are left out, so their
+    // variables are always resolved again
+    std::map<uint16_t, uint8_t> versions;
+    std::map<uint16_t, AppInfo> infos;
     for (auto itr = vars.begin(); itr != vars.end(); itr++) {
-        auto &adsVar = *static_cast<ADSDeviceVar *>(*itr);
-        auto dataType = adsVar.adsPV->addr->get_data_type();
-        auto func = adsVar.function();
-
-        if (func.find("[]") != std::string::npos ||
-            func.find("STRING") != std::string::npos) {
+        uint16_t adsPort = (*itr)->addr->get_ads_port();
+        if (versions.count(adsPort) != 0) {
+            continue;
+        }
 
-            auto const &nelem = adsVar.adsPV->addr->get_nelem();
+        uint8_t version;
+        if (adsConnection->read_symbol_version(adsPort, &version) == 0) {
+            versions[adsPort] = version;
 
-            switch (dataType) {
-            case ADSDataType::BOOL:
-            case ADSDataType::BYTE:
-            case ADSDataType::SINT: {
-                performArrayCallbacks<epicsInt8, epicsInt8>(adsVar, nelem);
-                break;
+            AppInfo info;
+            if (adsConnection->read_app_info(adsPort, &info) == 0) {
+                infos[adsPort] = info;
             }
+        }
+    }
 
-            case ADSDataType::INT: {
-                performArrayCallbacks<epicsInt16, epicsInt16>(adsVar, nelem);
-                break;
+    // the state the runtime was last seen in decides whether handles are
+    // kept when the connection is lost
+    uint16_t deviceState;
+    ADSState adsState = ADSState::Invalid;
+    if (adsConnection->read_device_state(&deviceState, &adsState) == 0) {
+        currentAdsState = adsState;
+        currentDeviceState = deviceState;
+    }
+
+    if (handlesKept) {
+        // a runtime restart invalidates all handles, while the 8-bit symbol
+        // version may come out the same; the runtime must be in RUN and the
+        // application info, where available, unchanged
+        std::set<uint16_t> keptPorts;
+        for (auto itr = versions.begin();
+             adsState == ADSState::Run && itr != versions.end(); itr++) {
+            auto oldVersion = symbolVersions.find(itr->first);
+            if (oldVersion == symbolVersions.end() ||
+                oldVersion->second != itr->second) {
+                continue;
             }
 
-            case ADSDataType::DINT: {
-                performArrayCallbacks<epicsInt32, epicsInt32>(adsVar, nelem);
-                break;
+            auto oldInfo = appInfos.find(itr->first);
+            auto newInfo = infos.find(itr->first);
+            if ((oldInfo == appInfos.end()) != (newInfo == infos.end())) {
+                continue;
             }
-            case ADSDataType::LINT: {
-                performArrayCallbacks<epicsInt64, epicsInt64>(adsVar, nelem);
-                break;
+            if (oldInfo != appInfos.end() &&
+                (oldInfo->second.app_timestamp !=
+                     newInfo->second.app_timestamp ||
+                 oldInfo->second.online_changes !=
+                     newInfo->second.online_changes)) {
+                continue;
             }
 
-            case ADSDataType::REAL: {
-                performArrayCallbacks<epicsFloat32, epicsFloat32>(adsVar,
-                                                                  nelem);
-                break;
-            }
+            keptPorts.insert(itr->first);
+            LOG_WARN_ASYN(pasynUser,
+                          "Symbols of ADS port %u unchanged, reusing "
+                          "variable handles",
+                          itr->first);
+        }
 
-            case ADSDataType::LREAL: {
-                performArrayCallbacks<epicsFloat64, epicsFloat64>(adsVar,
-                                                                  nelem);
-                break;
+        // the other handles are invalid on the ADS device, so they aren't
+        // released, just resolved again
+        for (auto itr = vars.begin(); itr != vars.end(); itr++) {
+            if (keptPorts.count((*itr)->addr->get_ads_port()) == 0) {
+                (*itr)->addr->unresolve();
             }
+        }
+        handlesKept = false;
+    }
 
-            case ADSDataType::USINT: {
-                performArrayCallbacks<epicsUInt8, epicsInt8>(adsVar, nelem);
-                break;
-            }
-            case ADSDataType::WORD:
-            case ADSDataType::UINT: {
-                performArrayCallbacks<epicsUInt16, epicsInt16>(adsVar, nelem);
-                break;
-            }
-            case ADSDataType::DWORD:
-            case ADSDataType::UDINT: {
-                performArrayCallbacks<epicsUInt32, epicsInt32>(adsVar, nelem);
-                break;
+    symbolVersions = versions;
+    appInfos = infos;
+}
+
+void ADSPortDriver::resolveFromSymbolTables(asynUser *pasynUser) {
+    std::map<uint16_t, std::vector<std::shared_ptr<ADSVariable>>> varsByPort;
+    std::vector<std::shared_ptr<ADSVariable>> vars = allVariables();
+    for (auto itr = vars.begin(); itr != vars.end(); itr++) {
+        if (!(*itr)->addr->is_resolved()) {
+            varsByPort[(*itr)->addr->get_ads_port()].push_back(*itr);
+        }
+    }
+
+    // variables that can't be resolved from the symbol table (e.g. structure
+    // members) are resolved with handles afterwards
+    for (auto itr = varsByPort.begin(); itr != varsByPort.end(); itr++) {
+        SymbolTable table;
+        int status = table.load(adsConnection, itr->first, symbolCacheDir);
+
+        // a cached table whose symbols don't match the device any more is
+        // uploaded again
+        if (status == 0 && table.is_cached()) {
+            int verifyStatus =
+                table.verify(adsConnection, itr->first, itr->second);
+            if (verifyStatus) {
+                LOG_WARN_ASYN(pasynUser,
+                              "Cached symbol table of ADS port %u doesn't "
+                              "match the device (%i): %s",
+                              itr->first, verifyStatus,
+                              ads_errors[verifyStatus].c_str());
+                status = table.load(adsConnection, itr->first, symbolCacheDir,
+                                    false);
             }
+        }
 
-            case ADSDataType::STRING: {
-                std::vector<char> buffer(nelem);
-                Autoparam::Octet readArray(buffer.data(), buffer.size());
+        if (status) {
+            LOG_WARN_ASYN(pasynUser,
+                          "Could not load symbol table of ADS port %u (%i): %s",
+                          itr->first, status, ads_errors[status].c_str());
+            continue;
+        }
 
-                OctetReadResult result = stringRead(adsVar, readArray);
+        size_t resolved = table.resolve_variables(itr->second);
+        LOG_WARN_ASYN(pasynUser,
+                      "Resolved %lu of %lu variable names of ADS port %u from "
+                      "symbol table (%lu symbols)",
+                      resolved, itr->second.size(), itr->first, table.size());
+    }
+}
 
-                setParam(adsVar, readArray, result.status, result.alarmStatus,
-                         result.alarmSeverity);
-                break;
-            }
-            default:
-                // error unknown data type
-                break;
-            }
+void ADSPortDriver::addElementVariable(std::shared_ptr<ADSVariable> element) {
+    auto parentAddr = std::make_shared<ADSAddress>(
+        *element->addr, element->addr->get_parent_name());
 
-        } else if (func.find("_digi") != std::string::npos) {
-            switch (dataType) {
-            case ADSDataType::BOOL:
-            case ADSDataType::BYTE:
-            case ADSDataType::USINT: {
-                UInt32ReadResult result =
-                    digitalRead<epicsUInt8>(adsVar, 0xFFFF);
+    ElementParent &parent = elementParents[sharedVariableKey(*parentAddr)];
+    if (parent.variable == nullptr) {
+        parent.variable = std::make_shared<ADSVariable>(parentAddr);
+        parent.variable->set_connection(adsConnection);
+        ads_read_vars.push_back(parent.variable);
+    }
+    parent.elements.push_back(element);
+}
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
+void ADSPortDriver::locateElements(asynUser *pasynUser) {
+    // the symbol infos of all parents and array elements that must be
+    // located are read with ADS sum requests, grouped by ADS port
+    std::map<uint16_t, std::set<std::string>> names;
+    for (auto itr = elementParents.begin(); itr != elementParents.end();
+         itr++) {
+        std::shared_ptr<ADSVariable> parent = itr->second.variable;
+        if (parent->addr->is_resolved()) {
+            continue;
+        }
+
+        std::set<std::string> &portNames =
+            names[parent->addr->get_ads_port()];
+        portNames.insert(parent->addr->get_var_name());
+        for (auto elem = itr->second.elements.begin();
+             elem != itr->second.elements.end(); elem++) {
+            if (!(*elem)->addr->has_element_offset()) {
+                portNames.insert((*elem)->addr->get_var_name());
             }
-            case ADSDataType::WORD:
-            case ADSDataType::UINT: {
-                UInt32ReadResult result =
-                    digitalRead<epicsUInt16>(adsVar, 0xFFFF);
+        }
+    }
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
+    std::map<std::pair<uint16_t, std::string>, SymbolInfo> symbolInfos;
+    for (auto itr = names.begin(); itr != names.end(); itr++) {
+        std::vector<std::string> portNames(itr->second.begin(),
+                                           itr->second.end());
+        std::vector<SymbolInfo> infos;
+        std::vector<int> statuses;
+        adsConnection->read_symbol_infos(itr->first, portNames, infos,
+                                         statuses);
+        for (size_t i = 0; i < portNames.size(); i++) {
+            if (statuses[i] == 0) {
+                symbolInfos[{itr->first, portNames[i]}] = infos[i];
             }
-            case ADSDataType::DWORD:
-            case ADSDataType::UDINT: {
-                UInt32ReadResult result =
-                    digitalRead<epicsUInt32>(adsVar, 0xFFFF);
+        }
+    }
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
+    for (auto itr = elementParents.begin(); itr != elementParents.end();
+         itr++) {
+        std::shared_ptr<ADSVariable> parent = itr->second.variable;
+        std::vector<std::shared_ptr<ADSVariable>> &elements =
+            itr->second.elements;
+
+        // a parent kept resolved from the previous connection is unchanged,
+        // and so are the offsets of its elements
+        if (parent->addr->is_resolved()) {
+            continue;
+        }
+
+        uint16_t adsPort = parent->addr->get_ads_port();
+        auto parentItr =
+            symbolInfos.find({adsPort, parent->addr->get_var_name()});
+        bool parentLocated = parentItr != symbolInfos.end();
+        SymbolInfo parentInfo = {};
+        if (parentLocated) {
+            parentInfo = parentItr->second;
+        }
+
+        // the offsets of array elements are the difference between the
+        // element's and the parent's index offset
+        std::vector<std::pair<std::shared_ptr<ADSVariable>, uint32_t>> located;
+        uint64_t start = UINT32_MAX;
+        uint64_t end = 0;
+        for (auto elem = elements.begin(); elem != elements.end(); elem++) {
+            (*elem)->set_read_source(nullptr);
+
+            uint32_t offset;
+            auto info =
+                symbolInfos.find({adsPort, (*elem)->addr->get_var_name()});
+            if ((*elem)->addr->has_element_offset()) {
+                offset = (*elem)->addr->get_element_offset();
+            } else if (parentLocated && info != symbolInfos.end() &&
+                       info->second.index_group == parentInfo.index_group &&
+                       info->second.index_offset >= parentInfo.index_offset) {
+                offset = info->second.index_offset - parentInfo.index_offset;
+            } else {
+                LOG_ERR_ASYN(pasynUser, "Could not locate array element '%s'",
+                             (*elem)->addr->info().c_str());
+                continue;
             }
-            default:
-                break;
+
+            if (parentLocated &&
+                (uint64_t)offset + (*elem)->size() > parentInfo.size) {
+                LOG_ERR_ASYN(pasynUser,
+                             "Element '%s' is outside of its variable (%u "
+                             "bytes)",
+                             (*elem)->addr->info().c_str(), parentInfo.size);
+                continue;
             }
 
+            located.push_back({*elem, offset});
+            start = std::min(start, (uint64_t)offset);
+            end = std::max(end, (uint64_t)offset + (*elem)->size());
+        }
+
+        // without its index group/offset, the parent is resolved with a
+        // handle or from the symbol table, and read from its start
+        if (located.empty() || !parentLocated) {
+            start = 0;
+        }
+        if (end <= start) {
+            end = start + 1;
+        }
+
+        parent->addr->set_nelem(end - start);
+        if (parentLocated) {
+            parent->addr->resolve(parentInfo.index_group,
+                                  parentInfo.index_offset + start);
+        }
+
+        for (auto elem = located.begin(); elem != located.end(); elem++) {
+            elem->first->set_read_source(parent, elem->second - start);
+        }
+
+        LOG_TRACE_ASYN(pasynUser, "Reading %lu of %lu elements of '%s'",
+                       located.size(), elements.size(),
+                       parent->addr->info().c_str());
+    }
+}
+
+int ADSPortDriver::allocateScanClasses() {
+    // read variables are grouped by their scan class
+    std::map<uint32_t, std::vector<std::shared_ptr<ADSVariable>>> varsByClass;
+    for (auto itr = ads_read_vars.begin(); itr != ads_read_vars.end(); itr++) {
+        varsByClass[(*itr)->addr->get_scan_class()].push_back(*itr);
+    }
+
+    scanClasses.clear();
+    scanClasses.reserve(varsByClass.size());
+    for (auto itr = varsByClass.begin(); itr != varsByClass.end(); itr++) {
+        std::chrono::milliseconds period = sumReadPeriod;
+        auto periodItr = scanClassPeriods.find(itr->first);
+        if (periodItr != scanClassPeriods.end()) {
+            period = periodItr->second;
+        } else if (itr->first != 0) {
+            LOG_WARN_ASYN(pasynUserSelf,
+                          "Scan class %u has no period set, using %ld ms",
+                          itr->first, (long)sumReadPeriod.count());
+        }
+
+        ScanClass cls;
+        cls.id = itr->first;
+        cls.period = period;
+        cls.sumRead.reset(new SumReadRequest(sumBufferSize, adsConnection,
+                                             sumReadParallelism));
+        cls.nextRead = std::chrono::steady_clock::now();
+        cls.decodePending = false;
+        cls.timing.reset(new ScanTiming());
+
+        int status = cls.sumRead->allocate(itr->second);
+        if (status) {
+            return status;
+        }
+        scanClasses.push_back(std::move(cls));
+    }
+
+    return 0;
+}
+
+void ADSPortDriver::scheduleNextRead(
+    ScanClass &scanClass, std::chrono::steady_clock::time_point readStart) {
+    ScanTiming &timing = *scanClass.timing;
+
+    int64_t jitter = std::chrono::duration_cast<std::chrono::microseconds>(
+                         readStart - scanClass.nextRead)
+                         .count();
+    timing.reads++;
+    timing.lastJitter_us = jitter;
+    timing.sumJitter_us += jitter;
+    if (jitter > timing.maxJitter_us) {
+        timing.maxJitter_us = jitter;
+    }
+
+    // deadlines are absolute, so the time spent reading and in callbacks
+    // doesn't add to the period
+    scanClass.nextRead += scanClass.period;
+
+    auto timeNow = std::chrono::steady_clock::now();
+    if (scanClass.nextRead > timeNow) {
+        return;
+    }
+
+    timing.overruns++;
+    switch (overrunPolicy.load()) {
+    case OverrunPolicy::Skip:
+        while (scanClass.nextRead <= timeNow) {
+            scanClass.nextRead += scanClass.period;
+            timing.skipped++;
+        }
+        break;
+    case OverrunPolicy::CatchUp:
+        if (timeNow - scanClass.nextRead > maxCatchUpPeriods * scanClass.period) {
+            scanClass.nextRead = timeNow;
+        }
+        break;
+    case OverrunPolicy::Stretch:
+        scanClass.nextRead = timeNow + scanClass.period;
+        break;
+    }
+}
+
+bool ADSPortDriver::scanClassesInitialized() {
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        if (!cls->sumRead->is_allocated() || !cls->sumRead->is_initialized()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+asynStatus ADSPortDriver::doSumRead(ScanClass &scanClass) {
+    asynStatus status = static_cast<asynStatus>(scanClass.sumRead->read());
+
+    if (status == asynSuccess) {
+        return status;
+    }
+
+    // if all chunks failed, the connection is only dropped when the ADS device
+    // doesn't respond anymore; readADSDeviceState() disconnects in that case
+    if (!scanClass.sumRead->has_persistent_failure()) {
+        if (readADSDeviceState() != asynSuccess) {
+            return status;
+        }
+
+        LOG_WARN_ASYN(pasynUserSelf,
+                      "Sum-read failed, but ADS device is responding");
+        return asynSuccess;
+    }
+
+    // a chunk that keeps failing needs its variables resolved again
+    LOG_WARN_ASYN(pasynUserSelf, "Cannot perform sum-read");
+    ADSDisconnect(pasynUserSelf);
+
+    return status;
+}
+
+void ADSPortDriver::flushWrites() {
+    SumWrite.flush(writeResults);
+    postWriteResults();
+}
+
+void ADSPortDriver::postWriteResults() {
+    if (writeResults.empty()) {
+        return;
+    }
+
+    std::lock_guard<ADSPortDriver> guard(*this);
+    bool anyFailed = false;
+
+    for (auto itr = writeResults.begin(); itr != writeResults.end(); itr++) {
+        // the written value is returned by the next read with readback, which
+        // is serialized by the driver lock
+        if (itr->status == 0) {
+            itr->variable->set_written(itr->data);
+            continue;
+        }
+
+        auto deviceVar = writeDeviceVars.find(itr->variable.get());
+        if (deviceVar == writeDeviceVars.end()) {
+            continue;
+        }
+
+        LOG_ERR_ASYN(pasynUserSelf, "Write failed(%i): %s", itr->status,
+                     ads_errors[itr->status].c_str());
+
+        // successful writes are posted by the readback, failed ones here
+        int index = deviceVar->second->asynIndex();
+        setParamStatus(index, asynError);
+        setParamAlarmStatus(index, WRITE_ALARM);
+        setParamAlarmSeverity(index, INVALID_ALARM);
+        anyFailed = true;
+    }
+    writeResults.clear();
+
+    if (anyFailed) {
+        callParamCallbacks();
+    }
+}
+
+int ADSPortDriver::writeVariable(ADSDeviceVar &deviceVar, char const *data,
+                                 uint32_t size) {
+    int status;
+    if (sumWriteEnabled) {
+        status = SumWrite.queue(deviceVar.adsPV, data, size);
+    } else {
+        status = deviceVar.adsPV->write(data, size);
+    }
+
+    // the readback shouldn't wait for the next scheduled read
+    if (status == 0 && deviceVar.adsPV->uses_write_readback()) {
+        requestRead(deviceVar.adsPV->addr->get_scan_class());
+    }
+
+    return status;
+}
+
+asynStatus ADSPortDriver::setScanClass(uint32_t scanClass,
+                                       std::chrono::milliseconds period) {
+    if (initialized) {
+        LOG_ERR_ASYN(pasynUserSelf,
+                     "Scan classes must be configured before iocInit");
+        return asynError;
+    }
+
+    if (period.count() < 1) {
+        LOG_ERR_ASYN(pasynUserSelf, "Scan class period must be positive");
+        return asynError;
+    }
+
+    scanClassPeriods[scanClass] = period;
+    return asynSuccess;
+}
+
+asynStatus ADSPortDriver::setOption(std::string const &option,
+                                    std::string const &value) {
+    if (option == "sum_write") {
+        if (value != "0" && value != "1") {
+            LOG_ERR_ASYN(pasynUserSelf, "Option '%s' must be 0 or 1",
+                         option.c_str());
+            return asynError;
+        }
+        sumWriteEnabled = (value == "1");
+    } else if (option == "symbol_table") {
+        if (value != "0" && value != "1") {
+            LOG_ERR_ASYN(pasynUserSelf, "Option '%s' must be 0 or 1",
+                         option.c_str());
+            return asynError;
+        }
+        symbolTableEnabled = (value == "1");
+    } else if (option == "symbol_cache") {
+        std::lock_guard<ADSPortDriver> guard(*this);
+        symbolCacheDir = value;
+    } else if (option == "fold_elements") {
+        if (initialized) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be set before iocInit",
+                         option.c_str());
+            return asynError;
+        }
+        if (value != "0" && value != "1") {
+            LOG_ERR_ASYN(pasynUserSelf, "Option '%s' must be 0 or 1",
+                         option.c_str());
+            return asynError;
+        }
+        foldElementsEnabled = (value == "1");
+    } else if (option == "merge_gap") {
+        char *end;
+        long gap = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || gap < -1) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be an integer of at least -1",
+                         option.c_str());
+            return asynError;
+        }
+        mergeGap = gap;
+    } else if (option == "deadband" || option == "relative_deadband") {
+        char *end;
+        double band = strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !(band >= 0)) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be a non-negative number",
+                         option.c_str());
+            return asynError;
+        }
+        if (option == "deadband") {
+            deadband = band;
         } else {
-            switch (dataType) {
-            case ADSDataType::BOOL:
-            case ADSDataType::BYTE:
-            case ADSDataType::SINT: {
-                Int32ReadResult result =
-                    integerRead<epicsInt8, epicsInt32>(adsVar);
-
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+            relativeDeadband = band;
+        }
+    } else if (option == "delivery_thread") {
+        if (initialized) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be set before iocInit",
+                         option.c_str());
+            return asynError;
+        }
+        if (value != "0" && value != "1") {
+            LOG_ERR_ASYN(pasynUserSelf, "Option '%s' must be 0 or 1",
+                         option.c_str());
+            return asynError;
+        }
+        deliveryThreadEnabled = (value == "1");
+    } else if (option == "delivery_ring_depth") {
+        if (initialized) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be set before iocInit",
+                         option.c_str());
+            return asynError;
+        }
+        char *end;
+        long depth = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || depth < 1) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be a positive integer",
+                         option.c_str());
+            return asynError;
+        }
+        deliveryRingDepth = depth;
+    } else if (option == "decode_workers") {
+        if (initialized) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be set before iocInit",
+                         option.c_str());
+            return asynError;
+        }
+        char *end;
+        long workers = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || workers < 1) {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be a positive integer",
+                         option.c_str());
+            return asynError;
+        }
+        decodeWorkers = workers;
+    } else if (option == "scan_overrun") {
+        if (value == "skip") {
+            overrunPolicy = OverrunPolicy::Skip;
+        } else if (value == "catchup") {
+            overrunPolicy = OverrunPolicy::CatchUp;
+        } else if (value == "stretch") {
+            overrunPolicy = OverrunPolicy::Stretch;
+        } else {
+            LOG_ERR_ASYN(pasynUserSelf,
+                         "Option '%s' must be skip, catchup or stretch",
+                         option.c_str());
+            return asynError;
+        }
+    } else {
+        LOG_ERR_ASYN(pasynUserSelf, "Unknown option '%s'", option.c_str());
+        return asynError;
+    }
 
-            case ADSDataType::INT: {
-                Int32ReadResult result =
-                    integerRead<epicsInt16, epicsInt32>(adsVar);
+    LOG_TRACE_ASYN(pasynUserSelf, "Option '%s' set to '%s'", option.c_str(),
+                   value.c_str());
+    return asynSuccess;
+}
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+void ADSPortDriver::report(FILE *fp, int details) {
+    Autoparam::Driver::report(fp, details);
 
-            case ADSDataType::DINT: {
-                Int32ReadResult result =
-                    integerRead<epicsInt32, epicsInt32>(adsVar);
+    // scan classes are only created in initHook
+    if (!initialized) {
+        return;
+    }
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+    fprintf(fp, "Read variables: %zu, shared by %zu more records\n",
+            ads_read_vars.size(), sharedReadUsers);
+    size_t numElements = 0;
+    for (auto itr = elementParents.begin(); itr != elementParents.end();
+         itr++) {
+        numElements += itr->second.elements.size();
+    }
+    fprintf(fp, "Element variables: %zu, read from %zu variables\n",
+            numElements, elementParents.size());
+
+    // unchanged array callbacks skipped since the previous report
+    auto timeNow = std::chrono::steady_clock::now();
+    uint64_t skipped = arrayPostsSkipped;
+    double elapsed =
+        std::chrono::duration<double>(timeNow - lastReportTime).count();
+    fprintf(fp,
+            "Array callbacks: %llu posted, %llu unchanged skipped (%.1f/s)\n",
+            (unsigned long long)arrayPosts.load(), (unsigned long long)skipped,
+            elapsed > 0 ? (skipped - lastReportSkipped) / elapsed : 0.0);
+    lastReportTime = timeNow;
+    lastReportSkipped = skipped;
+    fprintf(fp, "Deadband: %g, relative %g, %llu updates filtered\n",
+            deadband.load(), relativeDeadband.load(),
+            (unsigned long long)deadbandFiltered.load());
+
+    if (deliveryRing) {
+        fprintf(fp,
+                "Delivery thread: ring depth %zu, queued %zu, cycles %llu, "
+                "decoded %llu times, overflows %llu\n",
+                deliveryRing->capacity(), deliveryRing->size(),
+                (unsigned long long)deliveredCycles.load(),
+                (unsigned long long)deliveryPasses.load(),
+                (unsigned long long)deliveryOverflows.load());
+    }
+
+    fprintf(fp, "Decode workers: %zu, decoded %llu times, %llu in parallel\n",
+            decodeThreads.size() + 1,
+            (unsigned long long)decodePasses.load(),
+            (unsigned long long)parallelDecodePasses.load());
+
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        ScanTiming const &timing = *cls->timing;
+        uint64_t reads = timing.reads;
+
+        fprintf(fp, "Scan class %u (period %ld ms):\n", cls->id,
+                (long)cls->period.count());
+        fprintf(fp, "   - Reads: %llu\n", (unsigned long long)reads);
+        fprintf(fp, "   - Overruns: %llu, reads skipped: %llu\n",
+                (unsigned long long)timing.overruns.load(),
+                (unsigned long long)timing.skipped.load());
+        fprintf(fp, "   - Jitter [us]: last %lld, max %lld, mean %lld\n",
+                (long long)timing.lastJitter_us.load(),
+                (long long)timing.maxJitter_us.load(),
+                (long long)(reads ? timing.sumJitter_us / (int64_t)reads : 0));
+
+        if (details >= 1) {
+            cls->sumRead->print_info(fp, details);
+        }
+    }
+}
 
-            case ADSDataType::LINT: {
-                Int64ReadResult result =
-                    integerRead<epicsInt64, epicsInt64>(adsVar);
+void ADSPortDriver::performIOIntr() {
+    for (auto cls = scanClasses.begin(); cls != scanClasses.end(); cls++) {
+        if (!cls->decodePending) {
+            continue;
+        }
+        cls->decodePending = false;
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
+        queueUpdated(cls->intrVars);
+    }
+    queueUpdated(notifyIntrVars);
 
-                break;
-            }
+    if (decodeQueued()) {
+        callParamCallbacks();
+    }
+}
 
-            case ADSDataType::REAL: {
-                Float64ReadResult result = floatRead<epicsFloat32>(adsVar);
+void ADSPortDriver::queueUpdated(std::vector<IntrVariable> &vars,
+                                 std::vector<uint8_t> const *updated) {
+    for (size_t i = 0; i < vars.size(); i++) {
+        IntrVariable &intrVar = vars[i];
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
+        // only variables changed by the latest sum-read need to be decoded;
+        // the delivery thread gets the sum-read part from the scan thread
+        if (updated == nullptr) {
+            if (!intrVar.var->adsPV->is_updated()) {
+                continue;
             }
+        } else if (!(*updated)[i] && !intrVar.var->adsPV->readback_pending()) {
+            continue;
+        }
+
+        decodeQueue.push_back(intrVar);
+    }
+}
 
-            case ADSDataType::LREAL: {
-                Float64ReadResult result = floatRead<epicsFloat64>(adsVar);
+bool ADSPortDriver::decodeQueued() {
+    if (decodeQueue.empty()) {
+        return false;
+    }
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+    // waking the workers is only worth it for more than one chunk
+    if (!decodeThreads.empty() && decodeQueue.size() > decodeChunkSize) {
+        {
+            std::lock_guard<std::mutex> lock(decodeMtx);
+            decodeNextChunk = 0;
+            decodeBusy = decodeThreads.size();
+            decodeRound++;
+        }
+        decodeCondition.notify_all();
 
-            case ADSDataType::USINT: {
-                Int32ReadResult result =
-                    integerRead<epicsUInt8, epicsInt32>(adsVar);
+        decodeChunks();
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+        std::unique_lock<std::mutex> lock(decodeMtx);
+        decodeDoneCondition.wait(lock, [this] { return decodeBusy == 0; });
+        parallelDecodePasses++;
+    } else {
+        for (auto itr = decodeQueue.begin(); itr != decodeQueue.end(); itr++) {
+            itr->decode(*itr->var);
+        }
+    }
+    decodePasses++;
 
-            case ADSDataType::WORD:
-            case ADSDataType::UINT: {
-                Int32ReadResult result =
-                    integerRead<epicsUInt16, epicsInt32>(adsVar);
+    // parameters and callbacks are only touched by this thread, which holds
+    // the driver lock
+    for (auto itr = decodeQueue.begin(); itr != decodeQueue.end(); itr++) {
+        itr->post(*this, *itr->var);
+    }
+    decodeQueue.clear();
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+    return true;
+}
 
-            case ADSDataType::DWORD:
-            case ADSDataType::UDINT: {
-                Int64ReadResult result =
-                    integerRead<epicsUInt64, epicsInt64>(adsVar);
+void ADSPortDriver::decodeChunks() {
+    // chunks are taken one at a time, so a worker slowed down by large
+    // arrays doesn't hold up the others
+    size_t numChunks =
+        (decodeQueue.size() + decodeChunkSize - 1) / decodeChunkSize;
+    size_t chunk;
+    while ((chunk = decodeNextChunk++) < numChunks) {
+        size_t end =
+            std::min(decodeQueue.size(), (chunk + 1) * decodeChunkSize);
+        for (size_t i = chunk * decodeChunkSize; i < end; i++) {
+            decodeQueue[i].decode(*decodeQueue[i].var);
+        }
+    }
+}
 
-                setParam(adsVar, result.value, result.status,
-                         result.alarmStatus, result.alarmSeverity);
-                break;
-            }
+void ADSPortDriver::startDecodeWorkers() {
+    // the thread doing the callbacks is one of the workers
+    for (size_t i = 1; i < decodeWorkers; i++) {
+        decodeThreads.emplace_back(&ADSPortDriver::adsDecode, this);
+    }
+}
 
-            default:
-                // error unknown data type
+void ADSPortDriver::adsDecode() {
+    LOG_TRACE_ASYN(pasynUserSelf, "ADS decode thread starting");
+
+    uint64_t round = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(decodeMtx);
+            decodeCondition.wait(lock, [this, round] {
+                return decodeRound != round || exitCalled;
+            });
+            // a started round is finished even when exiting, as its caller
+            // waits for it
+            if (decodeRound == round) {
                 break;
             }
+            round = decodeRound;
+        }
+
+        decodeChunks();
+
+        std::lock_guard<std::mutex> lock(decodeMtx);
+        if (--decodeBusy == 0) {
+            decodeDoneCondition.notify_one();
         }
     }
-    callParamCallbacks();
+
+    LOG_TRACE_ASYN(pasynUserSelf, "ADS decode thread exiting");
+}
+
+template <typename ResultType>
+static void setDecodedStatus(ADSDeviceVar::Decoded &decoded,
+                             ResultType const &result) {
+    decoded.status = result.status;
+    decoded.alarmStatus = result.alarmStatus;
+    decoded.alarmSeverity = result.alarmSeverity;
+}
+
+template <typename PLCDataType, typename epicsDataType>
+void ADSPortDriver::decodeInteger(ADSDeviceVar &deviceVar) {
+    Result<epicsDataType> result =
+        integerRead<PLCDataType, epicsDataType>(deviceVar);
+
+    deviceVar.decoded.integer = result.value;
+    setDecodedStatus(deviceVar.decoded, result);
+}
+
+template <typename PLCDataType>
+void ADSPortDriver::decodeDigital(ADSDeviceVar &deviceVar) {
+    UInt32ReadResult result = digitalRead<PLCDataType>(deviceVar, 0xFFFF);
+
+    deviceVar.decoded.integer = result.value;
+    setDecodedStatus(deviceVar.decoded, result);
+}
+
+template <typename PLCDataType>
+void ADSPortDriver::decodeFloat(ADSDeviceVar &deviceVar) {
+    Float64ReadResult result = floatRead<PLCDataType>(deviceVar);
+
+    deviceVar.decoded.real = result.value;
+    setDecodedStatus(deviceVar.decoded, result);
+
+    // the deadband of the address overrides the one of the driver; write
+    // readbacks are always posted, so the written value is shown. The
+    // record's own address is used, as adsPV may be shared with records
+    // reading the same symbol with another deadband.
+    ADSAddress const &addr =
+        static_cast<ADSDeviceAddress const &>(deviceVar.address()).address;
+    if (addr.get_operation() != Operation::Read) {
+        deviceVar.decoded.changed = true;
+        return;
+    }
+    double absolute, relative;
+    if (addr.has_deadband()) {
+        absolute = addr.get_deadband();
+        relative = addr.get_relative_deadband();
+    } else {
+        absolute = deviceVar.driver->deadband;
+        relative = deviceVar.driver->relativeDeadband;
+    }
+    if (absolute == 0 && relative == 0) {
+        deviceVar.decoded.changed = true;
+        return;
+    }
+
+    // values are posted when they move out of both deadbands around the
+    // latest posted value, so the absolute deadband also applies to values
+    // around zero, where the relative one vanishes; NaN is always posted
+    double band =
+        std::max(absolute, relative * std::fabs(deviceVar.postedReal));
+    deviceVar.decoded.changed =
+        !deviceVar.posted || deviceVar.postedStatus != result.status ||
+        !(std::fabs(result.value - deviceVar.postedReal) <= band);
+}
+
+template <typename PLCDataType, typename epicsDataType>
+void ADSPortDriver::decodeArray(ADSDeviceVar &deviceVar) {
+    // the callback buffer is sized on the first callback and reused, so the
+    // data is copied once from the sum-read buffer without allocating
+    size_t nelem = deviceVar.adsPV->addr->get_nelem();
+    size_t size = nelem * sizeof(epicsDataType);
+    std::vector<char> &buffer = deviceVar.callbackBuffer;
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    Autoparam::Array<epicsDataType> readArray(
+        reinterpret_cast<epicsDataType *>(buffer.data()), nelem);
+
+    ArrayReadResult result =
+        arrayRead<PLCDataType, epicsDataType>(deviceVar, readArray);
+    deviceVar.decoded.size = readArray.size();
+    setDecodedStatus(deviceVar.decoded, result);
+
+    // Mimic the behavior of callParamCallbacks() by only doing the callbacks
+    // if the data or status has changed. Variables are only decoded when the
+    // sum-read changed, but elements and readbacks can be decoded with
+    // unchanged data, so it is compared with the latest callback.
+    std::vector<char> const &posted = deviceVar.postedBuffer;
+    deviceVar.decoded.changed =
+        !(deviceVar.posted && deviceVar.postedStatus == result.status &&
+          posted.size() == size &&
+          memcmp(posted.data(), buffer.data(), size) == 0);
+}
+
+void ADSPortDriver::decodeString(ADSDeviceVar &deviceVar) {
+    size_t nelem = deviceVar.adsPV->addr->get_nelem();
+    std::vector<char> &buffer = deviceVar.callbackBuffer;
+    if (buffer.size() < nelem) {
+        buffer.resize(nelem);
+    }
+    Autoparam::Octet readArray(buffer.data(), nelem);
+
+    OctetReadResult result = stringRead(deviceVar, readArray);
+    deviceVar.decoded.size = readArray.size();
+    setDecodedStatus(deviceVar.decoded, result);
+}
+
+template <typename epicsDataType>
+void ADSPortDriver::postInteger(ADSPortDriver &driver,
+                                ADSDeviceVar &deviceVar) {
+    ADSDeviceVar::Decoded const &decoded = deviceVar.decoded;
+
+    driver.setParam(deviceVar, static_cast<epicsDataType>(decoded.integer),
+                    decoded.status, decoded.alarmStatus,
+                    decoded.alarmSeverity);
+}
+
+void ADSPortDriver::postFloat(ADSPortDriver &driver, ADSDeviceVar &deviceVar) {
+    ADSDeviceVar::Decoded const &decoded = deviceVar.decoded;
+    if (!decoded.changed) {
+        driver.deadbandFiltered++;
+        return;
+    }
+
+    driver.setParam(deviceVar, decoded.real, decoded.status,
+                    decoded.alarmStatus, decoded.alarmSeverity);
+
+    deviceVar.posted = true;
+    deviceVar.postedStatus = decoded.status;
+    deviceVar.postedReal = decoded.real;
+}
+
+template <typename epicsDataType>
+void ADSPortDriver::postArray(ADSPortDriver &driver, ADSDeviceVar &deviceVar) {
+    ADSDeviceVar::Decoded const &decoded = deviceVar.decoded;
+    if (!decoded.changed) {
+        driver.arrayPostsSkipped++;
+        return;
+    }
+
+    std::vector<char> &buffer = deviceVar.callbackBuffer;
+    Autoparam::Array<epicsDataType> readArray(
+        reinterpret_cast<epicsDataType *>(buffer.data()), decoded.size);
+    readArray.setSize(decoded.size);
+
+    driver.doCallbacksArray(deviceVar, readArray, decoded.status,
+                            decoded.alarmStatus, decoded.alarmSeverity);
+    driver.arrayPosts++;
+
+    // the posted data is kept for the next comparison, and the previous one's
+    // buffer is reused for the next read
+    buffer.resize(decoded.size * sizeof(epicsDataType));
+    buffer.swap(deviceVar.postedBuffer);
+    deviceVar.posted = true;
+    deviceVar.postedStatus = decoded.status;
+}
+
+void ADSPortDriver::postString(ADSPortDriver &driver,
+                               ADSDeviceVar &deviceVar) {
+    ADSDeviceVar::Decoded const &decoded = deviceVar.decoded;
+    Autoparam::Octet readArray(deviceVar.callbackBuffer.data(),
+                               deviceVar.adsPV->addr->get_nelem());
+    readArray.setSize(decoded.size);
+
+    driver.setParam(deviceVar, readArray, decoded.status, decoded.alarmStatus,
+                    decoded.alarmSeverity);
+}
+
+ADSPortDriver::IntrVariable
+ADSPortDriver::selectDecoder(ADSDeviceVar &deviceVar) {
+    auto const &address =
+        static_cast<ADSDeviceAddress const &>(deviceVar.address()).address;
+    auto dataType = address.get_data_type();
+    auto const &func = deviceVar.function();
+
+    if (func.find("[]") != std::string::npos ||
+        func.find("STRING") != std::string::npos) {
+        switch (dataType) {
+        case ADSDataType::BOOL:
+        case ADSDataType::BYTE:
+        case ADSDataType::SINT:
+            return {&deviceVar, decodeArray<epicsInt8, epicsInt8>,
+                    postArray<epicsInt8>};
+        case ADSDataType::INT:
+            return {&deviceVar, decodeArray<epicsInt16, epicsInt16>,
+                    postArray<epicsInt16>};
+        case ADSDataType::DINT:
+            return {&deviceVar, decodeArray<epicsInt32, epicsInt32>,
+                    postArray<epicsInt32>};
+        case ADSDataType::LINT:
+            return {&deviceVar, decodeArray<epicsInt64, epicsInt64>,
+                    postArray<epicsInt64>};
+        case ADSDataType::REAL:
+            return {&deviceVar, decodeArray<epicsFloat32, epicsFloat32>,
+                    postArray<epicsFloat32>};
+        case ADSDataType::LREAL:
+            return {&deviceVar, decodeArray<epicsFloat64, epicsFloat64>,
+                    postArray<epicsFloat64>};
+        case ADSDataType::USINT:
+            return {&deviceVar, decodeArray<epicsUInt8, epicsInt8>,
+                    postArray<epicsInt8>};
+        case ADSDataType::WORD:
+        case ADSDataType::UINT:
+            return {&deviceVar, decodeArray<epicsUInt16, epicsInt16>,
+                    postArray<epicsInt16>};
+        case ADSDataType::DWORD:
+        case ADSDataType::UDINT:
+            return {&deviceVar, decodeArray<epicsUInt32, epicsInt32>,
+                    postArray<epicsInt32>};
+        case ADSDataType::STRING:
+            return {&deviceVar, decodeString, postString};
+        default:
+            return {&deviceVar, nullptr, nullptr};
+        }
+    } else if (func.find("_digi") != std::string::npos) {
+        switch (dataType) {
+        case ADSDataType::BOOL:
+        case ADSDataType::BYTE:
+        case ADSDataType::USINT:
+            return {&deviceVar, decodeDigital<epicsUInt8>,
+                    postInteger<epicsUInt32>};
+        case ADSDataType::WORD:
+        case ADSDataType::UINT:
+            return {&deviceVar, decodeDigital<epicsUInt16>,
+                    postInteger<epicsUInt32>};
+        case ADSDataType::DWORD:
+        case ADSDataType::UDINT:
+            return {&deviceVar, decodeDigital<epicsUInt32>,
+                    postInteger<epicsUInt32>};
+        default:
+            return {&deviceVar, nullptr, nullptr};
+        }
+    }
+
+    switch (dataType) {
+    case ADSDataType::BOOL:
+    case ADSDataType::BYTE:
+    case ADSDataType::SINT:
+        return {&deviceVar, decodeInteger<epicsInt8, epicsInt32>,
+                postInteger<epicsInt32>};
+    case ADSDataType::INT:
+        return {&deviceVar, decodeInteger<epicsInt16, epicsInt32>,
+                postInteger<epicsInt32>};
+    case ADSDataType::DINT:
+        return {&deviceVar, decodeInteger<epicsInt32, epicsInt32>,
+                postInteger<epicsInt32>};
+    case ADSDataType::LINT:
+        return {&deviceVar, decodeInteger<epicsInt64, epicsInt64>,
+                postInteger<epicsInt64>};
+    case ADSDataType::REAL:
+        return {&deviceVar, decodeFloat<epicsFloat32>, postFloat};
+    case ADSDataType::LREAL:
+        return {&deviceVar, decodeFloat<epicsFloat64>, postFloat};
+    case ADSDataType::USINT:
+        return {&deviceVar, decodeInteger<epicsUInt8, epicsInt32>,
+                postInteger<epicsInt32>};
+    case ADSDataType::WORD:
+    case ADSDataType::UINT:
+        return {&deviceVar, decodeInteger<epicsUInt16, epicsInt32>,
+                postInteger<epicsInt32>};
+    case ADSDataType::DWORD:
+    case ADSDataType::UDINT:
+        return {&deviceVar, decodeInteger<epicsUInt32, epicsInt64>,
+                postInteger<epicsInt64>};
+    default:
+        return {&deviceVar, nullptr, nullptr};
+    }
 }
 
 template <typename PLCDataType, typename epicsDataType>
@@ -827,10 +2080,9 @@ WriteResult ADSPortDriver::integerWrite(DeviceVariable &deviceVar,
                                         epicsDataType val) {
     WriteResult result;
     auto &info = static_cast<ADSDeviceVar &>(deviceVar);
-    auto adsVar = info.adsPV;
 
-    auto status = adsVar->write(reinterpret_cast<char const *>(&val),
-                                sizeof(PLCDataType));
+    auto status = info.driver->writeVariable(
+        info, reinterpret_cast<char const *>(&val), sizeof(PLCDataType));
 
     if (status) {
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Write failed(%i): %s", status,
@@ -846,11 +2098,10 @@ WriteResult ADSPortDriver::floatWrite(DeviceVariable &deviceVar,
                                       epicsFloat64 val) {
     WriteResult result;
     auto &info = static_cast<ADSDeviceVar &>(deviceVar);
-    auto adsVar = info.adsPV;
 
     PLCDataType rawVal = static_cast<PLCDataType>(val);
-    auto status = adsVar->write(reinterpret_cast<char const *>(&rawVal),
-                                sizeof(PLCDataType));
+    auto status = info.driver->writeVariable(
+        info, reinterpret_cast<char const *>(&rawVal), sizeof(PLCDataType));
     if (status) {
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Write failed(%i): %s", status,
                      ads_errors[status].c_str());
@@ -866,7 +2117,6 @@ WriteResult ADSPortDriver::digitalWrite(DeviceVariable &deviceVar,
                                         epicsUInt32 const mask) {
     WriteResult result;
     auto &info = static_cast<ADSDeviceVar &>(deviceVar);
-    auto adsVar = info.adsPV;
 
     PLCDataType valueToWrite = static_cast<PLCDataType>(val);
 
@@ -882,8 +2132,8 @@ WriteResult ADSPortDriver::digitalWrite(DeviceVariable &deviceVar,
         valueToWrite = static_cast<PLCDataType>(currentRead.value);
     }
 
-    auto status = adsVar->write(reinterpret_cast<char *>(&valueToWrite),
-                                sizeof(PLCDataType));
+    auto status = info.driver->writeVariable(
+        info, reinterpret_cast<char *>(&valueToWrite), sizeof(PLCDataType));
     if (status) {
         // log error
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Write failed(%i): %s", status,
@@ -941,8 +2191,8 @@ WriteResult ADSPortDriver::arrayWrite(DeviceVariable &deviceVar,
     auto adsVar = info.adsPV;
 
     size_t bytesToWrite = sizeof(PLCDataType) * adsVar->addr->get_nelem();
-    auto status =
-        adsVar->write(reinterpret_cast<char *>(val.data()), bytesToWrite);
+    auto status = info.driver->writeVariable(
+        info, reinterpret_cast<char *>(val.data()), bytesToWrite);
     if (status) {
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Write failed(%i): %s", status,
                      ads_errors[status].c_str());
@@ -964,9 +2214,17 @@ OctetReadResult ADSPortDriver::stringRead(DeviceVariable &deviceVar,
         return result;
     }
 
+    // the string is read directly into the record's buffer if it fits
+    // together with the terminator, like arrayRead does; otherwise it is
+    // truncated by fillFrom
     size_t bytesToRead = adsVar->addr->get_nelem();
-    std::vector<char> buffer(bytesToRead);
-    auto status = adsVar->read_from_buffer(bytesToRead, buffer.data());
+    std::vector<char> buffer;
+    char *readTo = val.data();
+    if (val.maxSize() <= bytesToRead) {
+        buffer.resize(bytesToRead);
+        readTo = buffer.data();
+    }
+    auto status = adsVar->read_from_buffer(bytesToRead, readTo);
     if (status) {
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Read failed(%i): %s", status,
                      ads_errors[status].c_str());
@@ -974,7 +2232,12 @@ OctetReadResult ADSPortDriver::stringRead(DeviceVariable &deviceVar,
         return result;
     }
 
-    val.fillFrom(buffer.data(), buffer.size());
+    if (readTo == val.data()) {
+        val.setSize(bytesToRead);
+        val.data()[bytesToRead] = '\0';
+    } else {
+        val.fillFrom(buffer.data(), bytesToRead);
+    }
     return result;
 }
 
@@ -985,7 +2248,7 @@ WriteResult ADSPortDriver::stringWrite(DeviceVariable &deviceVar,
     auto adsVar = info.adsPV;
 
     size_t bytesToWrite = adsVar->addr->get_nelem();
-    auto status = adsVar->write(val.data(), bytesToWrite);
+    auto status = info.driver->writeVariable(info, val.data(), bytesToWrite);
     if (status) {
         LOG_ERR_ASYN(info.driver->pasynUserSelf, "Write failed(%i): %s", status,
                      ads_errors[status].c_str());
@@ -11,11 +11,13 @@
 #endif /* ifndef USE_TC_ADS */
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -27,7 +29,10 @@
 #include <AdsLib.h>
 #endif /* ifdef USE_TC_ADS */
 #include <autoparamDriver.h>
+#include <Connection.h>
+#include <SpscRing.h>
 #include <SumReadRequest.h>
+#include <SumWriteRequest.h>
 #include <Types.h>
 #include <Variable.h>
 
@@ -43,6 +48,21 @@ constexpr uint16_t defaultDeviceReadADSPort = AMSPORT_R0_PLC_TC3;
 constexpr std::chrono::seconds deviceInfoPeriod{5};
 constexpr std::chrono::milliseconds waitForConnectionPeriod{500};
 constexpr std::chrono::milliseconds defaultSumReadPeriod{1};
+constexpr uint16_t defaultSumReadParallelism = 1;
+constexpr size_t defaultDeliveryRingDepth = 4;
+// updated I/O Intr variables are split into chunks of this many variables
+// between decode workers; smaller batches are decoded by a single thread
+constexpr size_t decodeChunkSize = 256;
+// with the catch-up overrun policy, a scan class that falls further behind
+// than this is re-aligned to the current time
+constexpr unsigned maxCatchUpPeriods = 10;
+
+// what the scan thread does when a scan class misses its deadline
+enum class OverrunPolicy {
+    Skip,    // drop the missed reads and keep the original schedule
+    CatchUp, // read again immediately until the schedule is caught up
+    Stretch  // restart the schedule at the time of the late read
+};
 
 class ADSPortDriver;
 
@@ -60,18 +80,54 @@ class ADSDeviceVar : public DeviceVariable {
     ADSDeviceVar(DeviceVariable *baseInfo, ADSPortDriver *driver);
     ADSPortDriver *driver;
     std::shared_ptr<ADSVariable> adsPV;
+
+    // value passed to I/O Intr callbacks of array and string variables,
+    // reused by every callback and sized on first use
+    std::vector<char> callbackBuffer;
+
+    // value and status of the latest callback; unchanged arrays and floats
+    // within their deadband are not posted again
+    std::vector<char> postedBuffer;
+    epicsFloat64 postedReal = 0;
+    bool posted = false;
+    asynStatus postedStatus = asynSuccess;
+
+    // value decoded for I/O Intr callbacks, posted once all updated variables
+    // are decoded; integer and digital values are kept in `integer`, arrays
+    // and strings in callbackBuffer
+    struct Decoded {
+        epicsInt64 integer = 0;
+        epicsFloat64 real = 0;
+        size_t size = 0;      // elements in callbackBuffer
+        bool changed = false; // to be posted (arrays and floats)
+        asynStatus status = asynSuccess;
+        epicsAlarmCondition alarmStatus = epicsAlarmNone;
+        epicsAlarmSeverity alarmSeverity = epicsSevNone;
+    } decoded;
 };
 
 class ADSPortDriver : public Autoparam::Driver {
   public:
     ADSPortDriver(char const *portName, char const *ipAddr,
                   char const *amsNetId, uint16_t sumBufferSize,
-                  uint32_t adsFunctionTimeout, uint16_t deviceReadAdsPort, std::chrono::milliseconds sumReadPeriod);
+                  uint32_t adsFunctionTimeout, uint16_t deviceReadAdsPort, std::chrono::milliseconds sumReadPeriod,
+                  uint16_t sumReadParallelism);
 
     ~ADSPortDriver();
 
     asynStatus ADSConnect(asynUser *pasynUser);
-    asynStatus ADSDisconnect(asynUser *pasynUser);
+    // with keepHandles, variable handles are kept for the next ADSConnect,
+    // which reuses them if the symbol version of the ADS device is unchanged
+    asynStatus ADSDisconnect(asynUser *pasynUser, bool keepHandles = false);
+
+    // runtime options, set with the AdsSetOption iocsh command
+    asynStatus setOption(std::string const &option, std::string const &value);
+
+    // set the sum-read period of a scan class, must be called before iocInit
+    asynStatus setScanClass(uint32_t scanClass,
+                            std::chrono::milliseconds period);
+
+    void report(FILE *fp, int details) override;
 
   private:
     std::string portName;
@@ -81,22 +137,156 @@ class ADSPortDriver : public Autoparam::Driver {
     uint32_t const adsFunctionTimeout;
     uint16_t deviceReadAdsPort;
     const std::chrono::milliseconds sumReadPeriod;
+    uint16_t const sumReadParallelism;
     const std::shared_ptr<Connection> adsConnection;
 
-    SumReadRequest SumRead;
+    // decoders read the value of an I/O Intr variable from the sum-read
+    // buffer into ADSDeviceVar::decoded, posters update its parameter with
+    // it; a pair is bound to each variable in initHook. Decoders only touch
+    // their own variable, so different variables can be decoded in parallel.
+    typedef void (*Decoder)(ADSDeviceVar &deviceVar);
+    typedef void (*Poster)(ADSPortDriver &driver, ADSDeviceVar &deviceVar);
+    struct IntrVariable {
+        ADSDeviceVar *var;
+        Decoder decode;
+        Poster post;
+    };
+
+    // scheduling statistics of a scan class, read by report()
+    struct ScanTiming {
+        std::atomic<uint64_t> reads{0};
+        std::atomic<uint64_t> overruns{0};    // deadlines missed
+        std::atomic<uint64_t> skipped{0};     // reads dropped by Skip policy
+        std::atomic<int64_t> lastJitter_us{0}; // read start - deadline
+        std::atomic<int64_t> maxJitter_us{0};
+        std::atomic<int64_t> sumJitter_us{0};
+    };
+
+    // read variables are sum-read in scan classes (S= address option), each
+    // with its own sum-read request and period
+    struct ScanClass {
+        uint32_t id;
+        std::chrono::milliseconds period;
+        std::unique_ptr<SumReadRequest> sumRead;
+        std::vector<IntrVariable> intrVars;
+        std::chrono::steady_clock::time_point nextRead; // absolute deadline
+        bool decodePending; // read, but I/O Intr variables not decoded yet
+        std::unique_ptr<ScanTiming> timing;
+    };
+    std::map<uint32_t, std::chrono::milliseconds> scanClassPeriods;
+    std::vector<ScanClass> scanClasses;
+
+    // I/O Intr variables updated by ADS device notifications
+    std::vector<IntrVariable> notifyIntrVars;
+
+    // with the delivery thread, the scan thread hands each cycle over to it
+    // instead of decoding: which scan classes were read (by index in
+    // scanClasses) and which of their I/O Intr variables were updated
+    struct DeliveryCycle {
+        std::vector<uint8_t> classRead;
+        std::vector<std::vector<uint8_t>> updated;
+    };
+    std::atomic<bool> deliveryThreadEnabled;
+    size_t deliveryRingDepth;
+    std::unique_ptr<SpscRing<DeliveryCycle>> deliveryRing;
+    // cycles that didn't fit into the full ring, handed over with the next
+    // one; only used by the scan thread
+    DeliveryCycle deliveryCarry;
+    bool deliveryCarryPending;
+    std::atomic<uint64_t> deliveredCycles;   // cycles taken from the ring
+    std::atomic<uint64_t> deliveryPasses;    // decodes of taken cycles
+    std::atomic<uint64_t> deliveryOverflows; // cycles carried over
+
+    // updated I/O Intr variables of a cycle, decoded by decodeQueued()
+    std::vector<IntrVariable> decodeQueue;
+    // with more than one decode worker, chunks of decodeQueue are decoded by
+    // decodeThreads alongside the thread doing the callbacks
+    size_t decodeWorkers;
+    std::vector<std::thread> decodeThreads;
+    std::atomic<size_t> decodeNextChunk;
+    std::mutex decodeMtx;
+    std::condition_variable decodeCondition;     // new round or shutdown
+    std::condition_variable decodeDoneCondition; // round decoded
+    uint64_t decodeRound; // guarded by decodeMtx
+    size_t decodeBusy;    // workers still decoding; guarded by decodeMtx
+    std::atomic<uint64_t> decodePasses;
+    std::atomic<uint64_t> parallelDecodePasses;
+
+    // writes are queued and sent once per scan cycle when sum-write is enabled
+    SumWriteRequest SumWrite;
+    std::atomic<bool> sumWriteEnabled;
+    std::atomic<OverrunPolicy> overrunPolicy;
+    std::vector<SumWriteResult> writeResults;
+    std::map<ADSVariable *, ADSDeviceVar *> writeDeviceVars;
 
     std::thread adsScanThread;
+    std::thread deliveryThread;
     std::atomic<bool> exitCalled;
 
+    // the scan thread waits on scanCondition between cycles; it is woken by
+    // initHook, shutdown, ADS device notifications and writes with readback
+    std::mutex scanMtx;
+    std::condition_variable scanCondition;
+    bool scanWakeRequested;              // guarded by scanMtx
+    std::set<uint32_t> scanReadRequests; // guarded by scanMtx
+
+    std::mutex deliveryMtx;
+    std::condition_variable deliveryCondition;
+    bool deliveryWakeRequested; // guarded by deliveryMtx
+
     std::atomic<bool> initialized;
 
     std::vector< std::shared_ptr<ADSVariable>> ads_read_vars;
     std::vector< std::shared_ptr<ADSVariable>> ads_write_vars;
+    // read variables with D= are updated by ADS device notifications
+    std::vector< std::shared_ptr<ADSVariable>> ads_notify_vars;
+
+    // read variables by symbol, shared by all records that read the same data
+    std::map<std::string, std::shared_ptr<ADSVariable>> sharedReadVars;
+    size_t sharedReadUsers; // records using a variable created for another
+
+    // read variables with an element offset (OFFS=), and with fold_elements
+    // those addressed as array elements (V=MAIN.values[3]), are read from
+    // their parent variable, which is read once for all its elements
+    std::atomic<bool> foldElementsEnabled;
+    struct ElementParent {
+        std::shared_ptr<ADSVariable> variable;
+        std::vector<std::shared_ptr<ADSVariable>> elements;
+    };
+    std::map<std::string, ElementParent> elementParents;
+
+    // array callbacks, and the ones skipped because the data was unchanged
+    std::atomic<uint64_t> arrayPosts;
+    std::atomic<uint64_t> arrayPostsSkipped;
+    std::chrono::steady_clock::time_point lastReportTime; // for rates
+    uint64_t lastReportSkipped;
 
     DeviceVariable *createDeviceVariable(DeviceVariable *baseVar);
     DeviceAddress *parseDeviceAddress(std::string const &function,
                                       std::string const &arguments);
 
+    // symbol version of each ADS port, read when connecting
+    std::map<uint16_t, uint8_t> symbolVersions;
+    // application info of each TwinCAT 3 PLC port, read when connecting;
+    // together with the symbol version it tells if kept handles are valid
+    std::map<uint16_t, AppInfo> appInfos;
+    bool handlesKept;
+
+    // resolve variable names from the uploaded symbol table instead of with a
+    // handle for each variable; the table is cached in symbolCacheDir if set
+    std::atomic<bool> symbolTableEnabled;
+    std::string symbolCacheDir;
+
+    // variables resolved to index group/offset that are at most mergeGap
+    // bytes apart are read with a single sum-read entry; -1 disables merging
+    std::atomic<long> mergeGap;
+
+    // deadbands of REAL and LREAL I/O Intr variables without DB= or RDB=;
+    // values within the deadband of the latest posted value aren't posted
+    std::atomic<double> deadband;
+    std::atomic<double> relativeDeadband;
+    std::atomic<uint64_t> deadbandFiltered;
+
     ADSState currentAdsState;
     uint16_t currentDeviceState;
     std::string deviceInfo;
@@ -105,14 +295,63 @@ class ADSPortDriver : public Autoparam::Driver {
     // device info and state
     asynStatus readADSDeviceInfo();
     asynStatus readADSDeviceState();
-    asynStatus doSumRead();
+    // disconnect if the symbol version of an ADS port changed since
+    // connecting, so the variables are resolved again
+    asynStatus checkSymbolsChanged();
+    std::vector<std::shared_ptr<ADSVariable>> allVariables();
+    void checkSymbolVersions(asynUser *pasynUser);
+    void resolveFromSymbolTables(asynUser *pasynUser);
+    void addElementVariable(std::shared_ptr<ADSVariable> element);
+    // find the offsets of elements and size their parents to cover them
+    void locateElements(asynUser *pasynUser);
+    int allocateScanClasses();
+    bool scanClassesInitialized();
+    asynStatus doSumRead(ScanClass &scanClass);
+    void scheduleNextRead(ScanClass &scanClass,
+                          std::chrono::steady_clock::time_point readStart);
+    void flushWrites();
+    void postWriteResults();
+    int writeVariable(ADSDeviceVar &deviceVar, char const *data,
+                      uint32_t size);
 
-    template <typename PLCDataType, typename epicsDataType>
-    void performArrayCallbacks(ADSDeviceVar &parentDeviceVar,
-                               unsigned int const &nelem);
     void performIOIntr();
+    // queue VARS that were updated, or whose UPDATED flag is set if given
+    void queueUpdated(std::vector<IntrVariable> &vars,
+                      std::vector<uint8_t> const *updated = nullptr);
+    // decode and post the queued variables, false if there were none
+    bool decodeQueued();
+    void decodeChunks();
+    void startDecodeWorkers();
+    void adsDecode();
+    void startDelivery();
+    void handOffCycle();
+    void deliverCycle(DeliveryCycle &cycle);
+    void adsDeliver();
+
+    // decoder and poster of DEVICEVAR, both nullptr if unsupported
+    static IntrVariable selectDecoder(ADSDeviceVar &deviceVar);
+    template <typename PLCDataType, typename epicsDataType>
+    static void decodeInteger(ADSDeviceVar &deviceVar);
+    template <typename PLCDataType>
+    static void decodeDigital(ADSDeviceVar &deviceVar);
+    template <typename PLCDataType>
+    static void decodeFloat(ADSDeviceVar &deviceVar);
+    template <typename PLCDataType, typename epicsDataType>
+    static void decodeArray(ADSDeviceVar &deviceVar);
+    static void decodeString(ADSDeviceVar &deviceVar);
+    template <typename epicsDataType>
+    static void postInteger(ADSPortDriver &driver, ADSDeviceVar &deviceVar);
+    static void postFloat(ADSPortDriver &driver, ADSDeviceVar &deviceVar);
+    template <typename epicsDataType>
+    static void postArray(ADSPortDriver &driver, ADSDeviceVar &deviceVar);
+    static void postString(ADSPortDriver &driver, ADSDeviceVar &deviceVar);
 
     void signalExit();
+    void wakeScan();
+    // read SCANCLASS in the next scan cycle, regardless of its schedule
+    void requestRead(uint32_t scanClass);
+    // wait until UNTIL, or until the scan thread is woken
+    void waitScan(std::chrono::steady_clock::time_point until);
     void adsScan();
 
     // read/write for scalars
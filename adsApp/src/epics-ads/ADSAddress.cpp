@@ -10,6 +10,10 @@
 #include "err.h"
 #include "ADSAddress.h"
 
+#ifndef ADSIGRP_SYM_VALBYHND
+#define ADSIGRP_SYM_VALBYHND 0xF005
+#endif
+
 /* Helper functions */
 static ADSDataType parse_data_type(const std::string s);
 static ADSDataType parse_data_type_autoparam(const std::string s);
@@ -20,6 +24,9 @@ static uint16_t parse_ads_port(const std::string s);
 static uint32_t parse_index_group(const std::string s);
 static uint32_t parse_index_offset(const std::string s);
 static uint32_t parse_notification_delay(const std::string s);
+static uint32_t parse_scan_class(const std::string s);
+static uint32_t parse_element_offset(const std::string s);
+static double parse_deadband(const std::string s);
 static std::string parse_variable_name(const std::string s);
 static std::vector<std::string> tokenize(const std::string s);
 static std::string parse_param_value(const std::string s);
@@ -43,8 +50,48 @@ uint32_t ADSAddress::get_notification_delay() const {
     return this->ads_notification_delay;
 }
 
+uint32_t ADSAddress::get_scan_class() const { return this->scan_class; }
+
+bool ADSAddress::has_element_offset() const {
+    return this->element_offset_set;
+}
+
+uint32_t ADSAddress::get_element_offset() const {
+    return this->element_offset;
+}
+
+bool ADSAddress::has_deadband() const { return this->deadband_set; }
+
+double ADSAddress::get_deadband() const { return this->deadband; }
+
+double ADSAddress::get_relative_deadband() const {
+    return this->relative_deadband;
+}
+
+std::string ADSAddress::get_parent_name() const {
+    if (this->element_offset_set == true) {
+        return this->variable_name;
+    }
+
+    /* Array element, e.g. MAIN.values[3] or MAIN.matrix[1,2] */
+    size_t bracket = this->variable_name.rfind('[');
+    if (bracket == std::string::npos || bracket == 0 ||
+        this->variable_name.back() != ']') {
+        return "";
+    }
+
+    return this->variable_name.substr(0, bracket);
+}
+
+void ADSAddress::set_nelem(const uint32_t nelem) { this->nelem = nelem; }
+
 bool ADSAddress::is_resolved() const { return this->name_is_resolved; }
 
+bool ADSAddress::has_handle() const {
+    return this->variable_name != "" && this->name_is_resolved &&
+           this->index_group == ADSIGRP_SYM_VALBYHND;
+}
+
 const std::string ADSAddress::info() {
     std::ostringstream o;
 
@@ -58,6 +105,13 @@ const std::string ADSAddress::info() {
         o << "V=" << std::hex << this->get_var_name() << " (handle G=0x"
           << this->get_index_group() << " O=0x" << this->get_index_offset()
           << ")";
+        if (this->element_offset_set == true) {
+            o << " OFFS=0x" << this->element_offset;
+        }
+        if (this->deadband_set == true) {
+            o << std::dec << " DB=" << this->deadband
+              << " RDB=" << this->relative_deadband;
+        }
     } else {
         o << "G=0x" << std::hex << this->get_index_group() << " O=0x"
           << this->get_index_offset();
@@ -134,6 +188,7 @@ ADSAddress::ADSAddress(std::string const &function,
 
         // for now we support only variable specifier
         this->variable_name = parse_variable_name(arguments[3]);
+        this->parse_optional_specifiers(arguments, 4);
 
     } else if (function.find("_digi") != std::string::npos) {
         this->nelem = 0;
@@ -142,6 +197,7 @@ ADSAddress::ADSAddress(std::string const &function,
 
         // for now we support only variable specifier
         this->variable_name = parse_variable_name(arguments[2]);
+        this->parse_optional_specifiers(arguments, 3);
 
     } else {
         this->nelem = 0;
@@ -150,6 +206,7 @@ ADSAddress::ADSAddress(std::string const &function,
 
         // for now we support only variable specifier
         this->variable_name = parse_variable_name(arguments[2]);
+        this->parse_optional_specifiers(arguments, 3);
     }
 
     /* String type requires number of element parameter. Otherwise nelem is set
@@ -168,6 +225,12 @@ ADSAddress::ADSAddress(std::string const &function,
     this->name_is_resolved = false;
 }
 
+ADSAddress::ADSAddress(const ADSAddress &element,
+                       const std::string &parent_name)
+    : data_type(ADSDataType::BYTE), operation(Operation::Read),
+      variable_name(parent_name), ads_port(element.ads_port),
+      scan_class(element.scan_class), nelem(1) {}
+
 int ADSAddress::resolve(const uint32_t ads_index_group,
                         const uint32_t ads_index_offset) {
     if (this->name_is_resolved == true) {
@@ -229,6 +292,31 @@ void ADSAddress::parse_variable_specifier(
     }
 }
 
+void ADSAddress::parse_optional_specifiers(
+    const std::vector<std::string> &address_tokens, size_t first) {
+    for (size_t i = first; i < address_tokens.size(); i++) {
+        const std::string &token = address_tokens[i];
+
+        if (token.substr(0, 2) == "D=") {
+            this->ads_notification_delay = parse_notification_delay(token);
+        } else if (token.substr(0, 2) == "S=") {
+            this->scan_class = parse_scan_class(token);
+        } else if (token.substr(0, 5) == "OFFS=") {
+            this->element_offset = parse_element_offset(token);
+            this->element_offset_set = true;
+        } else if (token.substr(0, 3) == "DB=") {
+            this->deadband = parse_deadband(token);
+            this->deadband_set = true;
+        } else if (token.substr(0, 4) == "RDB=") {
+            this->relative_deadband = parse_deadband(token);
+            this->deadband_set = true;
+        } else {
+            throw std::invalid_argument("Invalid address specifier '" + token +
+                                        "'");
+        }
+    }
+}
+
 // autoparam version
 static ADSDataType parse_data_type_autoparam(const std::string s) {
     ADSDataType data_type;
@@ -422,6 +510,60 @@ static uint32_t parse_notification_delay(const std::string s) {
     return std::stol(value);
 }
 
+/* Parse sum-read scan class optional specifier. Expected format:
+ * "S=SCAN_CLASS", where SCAN_CLASS is an unsigned integer, e.g. "S=1".
+ *
+ * Throws std::invalid_argument if scan class is not specified or cannot be
+ * converted to integer. */
+static uint32_t parse_scan_class(const std::string s) {
+    const std::string value = parse_param_value(s);
+
+    try {
+        return parse_dec_or_hex_int(value);
+    } catch (...) {
+        throw std::invalid_argument("Invalid scan class '" + s + "'");
+    }
+}
+
+/* Parse element offset optional specifier. Expected format: "OFFS=OFFSET",
+ * where OFFSET is the byte offset of the element within the variable, e.g.
+ * "OFFS=48" or "OFFS=0x30".
+ *
+ * Throws std::invalid_argument if element offset is not specified or cannot be
+ * converted to integer. */
+static uint32_t parse_element_offset(const std::string s) {
+    const std::string value = parse_param_value(s);
+
+    try {
+        return parse_dec_or_hex_int(value);
+    } catch (...) {
+        throw std::invalid_argument("Invalid element offset '" + s + "'");
+    }
+}
+
+/* Parse absolute or relative deadband optional specifier. Expected format:
+ * "DB=DEADBAND" or "RDB=DEADBAND", where DEADBAND is a non-negative number,
+ * e.g. "DB=0.01" or "RDB=0.005" (0.5 % of the value).
+ *
+ * Throws std::invalid_argument if deadband is not specified, cannot be
+ * converted to a number or is negative. */
+static double parse_deadband(const std::string s) {
+    const std::string value = parse_param_value(s);
+
+    double deadband;
+    size_t end;
+    try {
+        deadband = std::stod(value, &end);
+    } catch (...) {
+        throw std::invalid_argument("Invalid deadband '" + s + "'");
+    }
+    if (end != value.size() || !(deadband >= 0)) {
+        throw std::invalid_argument("Invalid deadband '" + s + "'");
+    }
+
+    return deadband;
+}
+
 /* Split address specifier by ' ' into vector elements. */
 static std::vector<std::string> tokenize(const std::string s) {
     std::vector<std::string> tokens;
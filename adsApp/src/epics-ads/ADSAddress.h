@@ -21,13 +21,23 @@ class ADSAddress {
     uint32_t index_group = 0;
     uint32_t index_offset = 0;
     uint32_t ads_notification_delay = 0;
+    uint32_t scan_class = 0; /* Scan class the variable is sum-read in */
     uint32_t nelem = 0;
+    uint32_t element_offset = 0; /* Byte offset within the variable (OFFS=) */
+    bool element_offset_set = false;
+    double deadband = 0;          /* Absolute deadband (DB=) */
+    double relative_deadband = 0; /* Deadband relative to the value (RDB=) */
+    bool deadband_set = false;
 
     bool name_is_resolved = false;
 
     void parse_register_specifier(std::vector<std::string> &address_tokens);
     void parse_variable_specifier(std::vector<std::string> &address_tokens);
 
+    /* Parse optional KEY=VALUE specifiers ADDRESS_TOKENS[FIRST...] */
+    void parse_optional_specifiers(
+        const std::vector<std::string> &address_tokens, size_t first);
+
   public:
     ADSDataType get_data_type() const; /* Data type */
     std::string get_var_name() const;  /* Variable (symbol) name */
@@ -37,13 +47,38 @@ class ADSAddress {
     uint32_t get_index_group() const;  /* ADS index group */
     uint32_t get_index_offset() const; /* ADS index offset */
     uint32_t get_notification_delay() const; /* ADS notification delay */
+    uint32_t get_scan_class() const;          /* Sum-read scan class */
     uint32_t get_nelem()
         const; /* Number of elements: 1 for scalars, the rest for waveforms */
 
+    /* True if the data is at a byte offset within the variable (OFFS=) */
+    bool has_element_offset() const;
+    uint32_t get_element_offset() const;
+
+    /* True if the address sets a deadband (DB= or RDB=), which overrides the
+     * deadband of the ADS connection */
+    bool has_deadband() const;
+    double get_deadband() const;
+    double get_relative_deadband() const;
+
+    /* Name of the variable containing this one, if it is addressed as an
+     * array element (e.g. MAIN.values[3]) or with an element offset. Empty
+     * otherwise. */
+    std::string get_parent_name() const;
+
+    /* Change the number of elements, used for variables sized when
+     * connecting */
+    void set_nelem(const uint32_t nelem);
+
     /* True when ADS variable name resolved into group/offset specifiers. Always
      * true for variables addressed using index/offset. */
     bool is_resolved() const;
 
+    /* True when the variable is resolved with a handle, which must be released
+     * on the ADS device. Variables resolved from the symbol table address the
+     * variable directly. */
+    bool has_handle() const;
+
     /* Construct from address specifier.
      *
      * Expected format for register access:
@@ -57,12 +92,21 @@ class ADSAddress {
      * optional. */
     ADSAddress(const std::string address);
 
-    // this constructor is fo autoparam use
+    // this constructor is fo autoparam use, expected arguments are:
+    // [N=NELEM] OPERATION P=PORT V=VARIABLE_NAME [D=NOTIFY_DELAY]
+    // [S=SCAN_CLASS] [OFFS=ELEMENT_OFFSET] [DB=DEADBAND]
+    // [RDB=RELATIVE_DEADBAND]
     ADSAddress(std::string const &function,
                std::vector<std::string> const &arguments);
 
+    /* Construct the address of the variable named PARENT_NAME, which
+     * contains ELEMENT (see get_parent_name()). The variable is read as an
+     * array of bytes on the ADS port and in the scan class of ELEMENT. */
+    ADSAddress(const ADSAddress &element, const std::string &parent_name);
+
     /* Provide group/offset specifiers when ADS variable name is resolved, i.e.
-     * variable handle is acquired using ADSIGRP_SYM_HNDBYNAME request */
+     * variable handle is acquired using ADSIGRP_SYM_HNDBYNAME request or the
+     * variable is found in the symbol table */
     int resolve(const uint32_t ads_index_group,
                 const uint32_t ads_index_offset);
 
@@ -10,18 +10,20 @@
 
 struct BufferDataPosition {
     SumReadBuffer *buffer;
-    uint32_t off_result;
+    uint32_t off_result; /* Index of the read result, shared by variables
+                            read in the same range */
     size_t off_data;
+    uint32_t index; /* Index of the variable in the buffer */
 
     bool operator == (const BufferDataPosition& br) const {
-        return (this->buffer == br.buffer) && (this->off_result == br.off_result) && (this->off_data == br.off_data);
+        return (this->buffer == br.buffer) && (this->off_result == br.off_result) && (this->off_data == br.off_data) && (this->index == br.index);
     }
 
     bool operator != (const BufferDataPosition& br) const {
-        return (this->buffer != br.buffer) || (this->off_result != br.off_result) || (this->off_data != br.off_data);
+        return !(*this == br);
     }
 };
 
-const BufferDataPosition EMPTY_BUFFER_DATA_POSITION = {nullptr, 0, 0};
+const BufferDataPosition EMPTY_BUFFER_DATA_POSITION = {nullptr, 0, 0, 0};
 
 #endif /* BUFFERDATAPOSITION_H */
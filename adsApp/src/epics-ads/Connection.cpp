@@ -2,12 +2,135 @@
 //
 // SPDX-License-Identifier: MIT
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <map>
 #include <mutex>
+#include <unordered_map>
 #include "err.h"
 
 #include "Connection.h"
 
+#ifndef ADSIGRP_SYM_VERSION
+#define ADSIGRP_SYM_VERSION 0xF008
+#endif
+
+#ifndef ADSIGRP_SYM_VALBYNAME
+#define ADSIGRP_SYM_VALBYNAME 0xF004
+#endif
+
+#ifndef ADSIGRP_SYM_UPLOAD
+#define ADSIGRP_SYM_UPLOAD 0xF00B
+#endif
+
+#ifndef ADSIGRP_SYM_INFOBYNAMEEX
+#define ADSIGRP_SYM_INFOBYNAMEEX 0xF009
+#endif
+
+#ifndef ADSIGRP_SYM_UPLOADINFO2
+#define ADSIGRP_SYM_UPLOADINFO2 0xF00F
+#endif
+
+#ifndef ADSIGRP_SUMUP_WRITE
+#define ADSIGRP_SUMUP_WRITE 0xF081
+#endif
+
+#ifndef ADSIGRP_SUMUP_READWRITE
+#define ADSIGRP_SUMUP_READWRITE 0xF082
+#endif
+
+/* Entry of the request block of an ADS sum write request. The block is
+ * followed by the write data of all entries. The response contains a result
+ * code for each entry. */
+struct SumWriteRequestEntry {
+    uint32_t index_group;
+    uint32_t index_offset;
+    uint32_t length;
+};
+
+/* Entry of the request block of an ADS sum read-write request. The block is
+ * followed by the write data of all entries. */
+struct SumReadWriteRequestEntry {
+    uint32_t index_group;
+    uint32_t index_offset;
+    uint32_t read_length;
+    uint32_t write_length;
+};
+
+/* Entry of the result block of an ADS sum read-write response. The block is
+ * followed by the read data of all entries, LENGTH bytes each. */
+struct SumReadWriteResultEntry {
+    uint32_t result;
+    uint32_t length;
+};
+
+/* Variable with a registered ADS device notification, and the listener of its
+ * connection which is called after a value is stored. */
+struct NotificationTarget {
+    std::shared_ptr<ADSVariable> variable;
+    std::function<void()> listener;
+};
+
+/* Variables with registered ADS device notifications, by the hUser value that
+ * is passed to the notification callback. The callback is called by the ADS
+ * library's notification thread. */
+static std::mutex notification_registry_mtx;
+static std::unordered_map<uint32_t, NotificationTarget> notification_registry;
+static uint32_t notification_next_user = 1;
+
+static uint32_t register_notification_user(std::shared_ptr<ADSVariable> var,
+                                           std::function<void()> listener) {
+    std::lock_guard<std::mutex> lock(notification_registry_mtx);
+
+    /* hUser 0 is reserved for variables without notification */
+    uint32_t user = notification_next_user++;
+    if (user == 0) {
+        user = notification_next_user++;
+    }
+    notification_registry[user] = {var, listener};
+
+    return user;
+}
+
+static void unregister_notification_user(uint32_t user) {
+    std::lock_guard<std::mutex> lock(notification_registry_mtx);
+
+    notification_registry.erase(user);
+}
+
+#ifdef USE_TC_ADS
+static void __stdcall notification_callback(AmsAddr *addr,
+                                            AdsNotificationHeader *notification,
+                                            unsigned long user) {
+#else
+static void notification_callback(const AmsAddr *addr,
+                                  const AdsNotificationHeader *notification,
+                                  uint32_t user) {
+#endif
+    NotificationTarget target;
+    {
+        std::lock_guard<std::mutex> lock(notification_registry_mtx);
+        auto var_itr = notification_registry.find(user);
+        if (var_itr == notification_registry.end()) {
+            return;
+        }
+        target = var_itr->second;
+    }
+
+    /* Notification data follows the notification header */
+    target.variable->store_notification_value(
+        reinterpret_cast<const uint8_t *>(notification + 1),
+        notification->cbSampleSize);
+
+    if (target.listener) {
+        target.listener();
+    }
+}
 
+void Connection::set_notification_listener(std::function<void()> listener) {
+    this->notification_listener = listener;
+}
 
 bool Connection::is_connected() { return (this->ads_port != 0 ? true : false); }
 
@@ -17,17 +140,38 @@ const AmsNetId Connection::get_remote_ams_netid() {
 
 long Connection::get_ads_port() { return this->ads_port; }
 
+unsigned int Connection::get_num_lanes() {
+    return this->lane_ads_ports.size() + 1;
+}
+
+long Connection::get_lane_ads_port(unsigned int lane) {
+    if (lane == 0 || lane > this->lane_ads_ports.size()) {
+        return this->ads_port;
+    }
+
+    return this->lane_ads_ports[lane - 1];
+}
+
 Connection::Connection() {}
 
 Connection::~Connection() {}
 
+void Connection::set_sum_operations_max_commands(
+    const unsigned int max_commands) {
+    if (max_commands > 0) {
+        this->sum_operations_max_commands = max_commands;
+    }
+}
+
 void Connection::set_local_ams_id(const AmsNetId ams_id) {
 #ifndef USE_TC_ADS
     AdsSetLocalAddress(ams_id);
 #endif
 }
 
-int Connection::connect(const AmsNetId ams_id, const std::string address, const uint16_t device_read_ads_port) {
+int Connection::connect(const AmsNetId ams_id, const std::string address,
+                        const uint16_t device_read_ads_port,
+                        const unsigned int num_lanes) {
     std::lock_guard<epicsMutex> lock(this->mtx);
 
     /* Add AMS route */
@@ -39,12 +183,43 @@ int Connection::connect(const AmsNetId ams_id, const std::string address, const
     }
 #endif
 
+    /* Reuse the ports kept by disconnect(true), so that variable handles of
+     * the previous connection remain valid */
+    if (this->kept_ads_port != 0 &&
+        this->kept_lane_ads_ports.size() + 1 == num_lanes) {
+        this->remote_ams_netid = ams_id;
+        this->ads_port = this->kept_ads_port;
+        this->lane_ads_ports = this->kept_lane_ads_ports;
+        this->device_read_ads_port = device_read_ads_port;
+
+        this->kept_ads_port = 0;
+        this->kept_lane_ads_ports.clear();
+        return 0;
+    }
+    this->close_kept_ports();
+
     const long port = AdsPortOpenEx();
     if (port == 0) {
         LOG_ERR("could not open port to ADS device");
         return EPICSADS_DISCONNECTED;
     }
 
+    this->lane_ads_ports.clear();
+    for (unsigned int lane = 1; lane < num_lanes; lane++) {
+        const long lane_port = AdsPortOpenEx();
+        if (lane_port == 0) {
+            LOG_ERR("could not open port for sum-read lane %u", lane);
+            for (auto port_itr = this->lane_ads_ports.begin();
+                 port_itr != this->lane_ads_ports.end(); port_itr++) {
+                AdsPortCloseEx(*port_itr);
+            }
+            this->lane_ads_ports.clear();
+            AdsPortCloseEx(port);
+            return EPICSADS_DISCONNECTED;
+        }
+        this->lane_ads_ports.push_back(lane_port);
+    }
+
     this->remote_ams_netid = ams_id;
     this->ads_port = port;
     this->device_read_ads_port = device_read_ads_port;
@@ -52,15 +227,34 @@ int Connection::connect(const AmsNetId ams_id, const std::string address, const
     return 0;
 }
 
-int Connection::disconnect() {
+int Connection::disconnect(const bool keep_ports) {
     std::lock_guard<epicsMutex> lock(this->mtx);
 
     if (this->is_connected() == false) {
+        if (keep_ports == false) {
+            this->close_kept_ports();
+        }
         return EPICSADS_DISCONNECTED;
     }
 
-    AdsPortCloseEx(this->ads_port);
-    this->ads_port = 0;
+    if (keep_ports == true) {
+        this->close_kept_ports();
+        this->kept_ads_port = this->ads_port;
+        this->kept_lane_ads_ports = this->lane_ads_ports;
+        this->ads_port = 0;
+        this->lane_ads_ports.clear();
+    }
+
+    for (auto port_itr = this->lane_ads_ports.begin();
+         port_itr != this->lane_ads_ports.end(); port_itr++) {
+        AdsPortCloseEx(*port_itr);
+    }
+    this->lane_ads_ports.clear();
+
+    if (this->ads_port != 0) {
+        AdsPortCloseEx(this->ads_port);
+        this->ads_port = 0;
+    }
 
 #ifndef USE_TC_ADS
     /* TODO: does this bork other ADS connections? */
@@ -71,10 +265,43 @@ int Connection::disconnect() {
     return 0;
 }
 
+void Connection::close_kept_ports() {
+    for (auto port_itr = this->kept_lane_ads_ports.begin();
+         port_itr != this->kept_lane_ads_ports.end(); port_itr++) {
+        AdsPortCloseEx(*port_itr);
+    }
+    this->kept_lane_ads_ports.clear();
+
+    if (this->kept_ads_port != 0) {
+        AdsPortCloseEx(this->kept_ads_port);
+        this->kept_ads_port = 0;
+    }
+
+    /* Notifications are bound to the closed port */
+    this->stale_notifications.clear();
+}
+
+void Connection::delete_stale_notifications() {
+    /* Errors are ignored: the notifications are already gone if the ADS
+     * device was restarted in the meantime. */
+    for (auto itr = this->stale_notifications.begin();
+         itr != this->stale_notifications.end(); itr++) {
+        AmsAddr ams_addr = {this->remote_ams_netid, itr->ads_port};
+        long rc = AdsSyncDelDeviceNotificationReqEx(this->ads_port, &ams_addr,
+                                                    itr->handle);
+        if (rc != 0) {
+            LOG_TRACE("could not delete stale notification %u (%li)",
+                      itr->handle, rc);
+        }
+    }
+    this->stale_notifications.clear();
+}
+
 void Connection::set_disconnected() {
     std::lock_guard<epicsMutex> lock(this->mtx);
 
     this->ads_port = 0;
+    this->lane_ads_ports.clear();
     this->remote_ams_netid = {0, 0, 0, 0, 0, 0};
 }
 
@@ -85,6 +312,150 @@ int Connection::resolve_variable(std::shared_ptr<ADSVariable> ads_variable) {
     return this->resolve_variables(vec);
 }
 
+long Connection::request_handle(std::shared_ptr<ADSVariable> ads_variable,
+                                uint32_t *handle) {
+    const std::string &name = ads_variable->addr->get_var_name();
+    AmsAddr ams_addr = {this->remote_ams_netid,
+                        ads_variable->addr->get_ads_port()};
+
+    return AdsSyncReadWriteReqEx2(this->ads_port,        // ADS port
+                                  &ams_addr,             // AMS address
+                                  ADSIGRP_SYM_HNDBYNAME, // index group
+                                  0,                     // index offset
+                                  sizeof(*handle),       // read length
+                                  handle,                // read data
+                                  name.size(),           // write length
+                                  const_cast<char *>(name.c_str()), // write data
+                                  nullptr); // bytes read
+}
+
+int Connection::sum_resolve_variables(
+    const uint16_t ads_port,
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
+    const size_t nvars = ads_variables.size();
+    const size_t requests_size = nvars * sizeof(SumReadWriteRequestEntry);
+    const size_t results_size = nvars * sizeof(SumReadWriteResultEntry);
+
+    /* Write buffer: request entries, followed by variable names */
+    size_t names_size = 0;
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        names_size += (*var_itr)->addr->get_var_name().size();
+    }
+
+    std::vector<uint8_t> write_buffer;
+    std::vector<uint8_t> read_buffer;
+    try {
+        write_buffer.resize(requests_size + names_size);
+        read_buffer.resize(results_size + nvars * sizeof(uint32_t));
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not allocate sum resolve buffers: %s", ex.what());
+        return EPICSADS_ERROR;
+    }
+
+    SumReadWriteRequestEntry *requests =
+        (SumReadWriteRequestEntry *)write_buffer.data();
+    uint8_t *names = write_buffer.data() + requests_size;
+    for (size_t i = 0; i < nvars; i++) {
+        const std::string &name = ads_variables[i]->addr->get_var_name();
+        requests[i] = {ADSIGRP_SYM_HNDBYNAME, 0, sizeof(uint32_t),
+                       (uint32_t)name.size()};
+        memcpy(names, name.data(), name.size());
+        names += name.size();
+    }
+
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+    long rc = AdsSyncReadWriteReqEx2(
+        this->ads_port,          // ADS port
+        &ams_addr,               // AMS address
+        ADSIGRP_SUMUP_READWRITE, // index group
+        nvars, // offset; for SUMUP_READWRITE it is the number of commands
+        read_buffer.size(),  // read buffer size in bytes
+        read_buffer.data(),  // result codes, lengths and handles
+        write_buffer.size(), // write buffer size in bytes
+        write_buffer.data(), // handle requests and variable names
+        &bytes_read);        // number of bytes read
+
+    if (rc == ADSERR_DEVICE_SRVNOTSUPP) {
+        /* ADS device doesn't support sum commands, request handles one by
+         * one instead */
+        int status = 0;
+        for (auto var_itr = ads_variables.begin();
+             var_itr != ads_variables.end(); var_itr++) {
+            uint32_t handle = 0;
+            rc = this->request_handle(*var_itr, &handle);
+            if (rc != 0) {
+                LOG_WARN("could not resolve ADS variable '%s'",
+                         (*var_itr)->addr->get_var_name().c_str());
+                status = ads_rc_to_epicsads_error(rc);
+                continue;
+            }
+
+            if ((*var_itr)->addr->resolve(ADSIGRP_SYM_VALBYHND, handle) !=
+                0) {
+                status = EPICSADS_ERROR;
+            }
+        }
+        return status;
+    } else if (rc != 0) {
+        LOG_WARN("could not resolve %zu ADS variables on ADS port %u", nvars,
+                 ads_port);
+        return ads_rc_to_epicsads_error(rc);
+    }
+
+    if (bytes_read < results_size) {
+        LOG_ERR("sum resolve response too short (%zu bytes)",
+                (size_t)bytes_read);
+        return EPICSADS_ERROR;
+    }
+
+    /* Read buffer: result entries, followed by handles of variables that were
+     * resolved successfully */
+    const SumReadWriteResultEntry *results =
+        (const SumReadWriteResultEntry *)read_buffer.data();
+    const uint8_t *data = read_buffer.data() + results_size;
+    const uint8_t *data_end = read_buffer.data() + bytes_read;
+
+    int status = 0;
+    for (size_t i = 0; i < nvars; i++) {
+        const std::shared_ptr<ADSVariable> &ads_var = ads_variables[i];
+
+        if (results[i].length > (size_t)(data_end - data)) {
+            LOG_ERR("sum resolve response is truncated");
+            return EPICSADS_ERROR;
+        }
+        const uint8_t *entry_data = data;
+        data += results[i].length;
+
+        if (results[i].result != 0) {
+            LOG_WARN("could not resolve ADS variable '%s'",
+                     ads_var->addr->get_var_name().c_str());
+            status = ads_rc_to_epicsads_error(results[i].result);
+            continue;
+        }
+
+        uint32_t handle = 0;
+        if (results[i].length != sizeof(handle)) {
+            LOG_WARN("invalid handle length (%u) for ADS variable '%s'",
+                     results[i].length, ads_var->addr->get_var_name().c_str());
+            status = EPICSADS_ERROR;
+            continue;
+        }
+        memcpy(&handle, entry_data, sizeof(handle));
+
+        if (ads_var->addr->resolve(ADSIGRP_SYM_VALBYHND, handle) != 0) {
+            status = EPICSADS_ERROR;
+        }
+    }
+
+    return status;
+}
+
 int Connection::resolve_variables(
     const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
     std::lock_guard<epicsMutex> lock(this->mtx);
@@ -97,39 +468,35 @@ int Connection::resolve_variables(
         return EPICSADS_DISCONNECTED;
     }
 
-    int status = 0;
-    for (size_t i = 0; i < ads_variables.size(); i++) {
-        std::shared_ptr<ADSVariable> ads_var = ads_variables[i];
-        if (ads_var->addr->is_resolved() == true) {
+    /* Sum requests are sent to a single ADS port, so unresolved variables are
+     * grouped by ADS port first */
+    std::map<uint16_t, std::vector<std::shared_ptr<ADSVariable>>>
+        vars_by_ads_port;
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        if ((*var_itr)->addr->is_resolved() == true) {
             continue;
         }
+        vars_by_ads_port[(*var_itr)->addr->get_ads_port()].push_back(*var_itr);
+    }
 
-        // TODO: resolve handles using sum commands
-        uint32_t handle = 0;
-        AmsAddr ams_addr = {this->remote_ams_netid,
-                            ads_var->addr->get_ads_port()};
-        long rc = AdsSyncReadWriteReqEx2(
-            this->ads_port,                        // ADS port
-            &ams_addr,                             // AMS address
-            ADSIGRP_SYM_HNDBYNAME,                 // index group
-            0,                                     // index offset
-            sizeof(handle),                        // read length
-            &handle,                               // read data
-            ads_var->addr->get_var_name().size(),  // write length
-            const_cast<char*>(ads_var->addr->get_var_name().c_str()), // write data
-            nullptr);                              // bytes read
+    int status = 0;
+    std::vector<std::shared_ptr<ADSVariable>> chunk;
+    for (auto port_itr = vars_by_ads_port.begin();
+         port_itr != vars_by_ads_port.end(); port_itr++) {
+        const std::vector<std::shared_ptr<ADSVariable>> &vars =
+            port_itr->second;
 
-        if (rc != 0) {
-            LOG_WARN("could not resolve ADS variable '%s'",
-                     ads_var->addr->get_var_name().c_str());
-            status = ads_rc_to_epicsads_error(rc);
-            continue;
-        }
+        for (size_t start = 0; start < vars.size();
+             start += this->sum_operations_max_commands) {
+            size_t end =
+                std::min(vars.size(), start + this->sum_operations_max_commands);
+            chunk.assign(vars.begin() + start, vars.begin() + end);
 
-        rc = ads_var->addr->resolve(ADSIGRP_SYM_VALBYHND, handle);
-        if (rc != 0) {
-            status = EPICSADS_ERROR;
-            continue;
+            int rc = this->sum_resolve_variables(port_itr->first, chunk);
+            if (rc != 0) {
+                status = rc;
+            }
         }
     }
 
@@ -143,6 +510,104 @@ int Connection::unresolve_variable(std::shared_ptr<ADSVariable> ads_variable) {
     return this->unresolve_variables(vec);
 }
 
+long Connection::release_handle(std::shared_ptr<ADSVariable> ads_variable) {
+    uint32_t handle = ads_variable->addr->get_index_offset();
+    AmsAddr ams_addr = {this->remote_ams_netid,
+                        ads_variable->addr->get_ads_port()};
+
+    return AdsSyncWriteReqEx(this->ads_port,         // AMS port
+                             &ams_addr,              // AMS address
+                             ADSIGRP_SYM_RELEASEHND, // index group
+                             0,                      // index offset
+                             sizeof(handle),         // buffer length
+                             &handle);               // buffer
+}
+
+int Connection::sum_unresolve_variables(
+    const uint16_t ads_port,
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
+    const size_t nvars = ads_variables.size();
+    const size_t requests_size = nvars * sizeof(SumWriteRequestEntry);
+
+    /* Write buffer: request entries, followed by handles */
+    std::vector<uint8_t> write_buffer;
+    std::vector<uint32_t> results;
+    try {
+        write_buffer.resize(requests_size + nvars * sizeof(uint32_t));
+        results.resize(nvars);
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not allocate sum unresolve buffers: %s", ex.what());
+        return EPICSADS_ERROR;
+    }
+
+    SumWriteRequestEntry *requests =
+        (SumWriteRequestEntry *)write_buffer.data();
+    uint8_t *handles = write_buffer.data() + requests_size;
+    for (size_t i = 0; i < nvars; i++) {
+        uint32_t handle = ads_variables[i]->addr->get_index_offset();
+        requests[i] = {ADSIGRP_SYM_RELEASEHND, 0, sizeof(handle)};
+        memcpy(handles + i * sizeof(handle), &handle, sizeof(handle));
+    }
+
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+    long rc = AdsSyncReadWriteReqEx2(
+        this->ads_port,      // ADS port
+        &ams_addr,           // AMS address
+        ADSIGRP_SUMUP_WRITE, // index group
+        nvars, // offset; for SUMUP_WRITE it is the number of commands
+        results.size() * sizeof(uint32_t), // read buffer size in bytes
+        results.data(),      // result codes
+        write_buffer.size(), // write buffer size in bytes
+        write_buffer.data(), // release requests and handles
+        &bytes_read);        // number of bytes read
+
+    if (rc == ADSERR_DEVICE_SRVNOTSUPP) {
+        /* ADS device doesn't support sum commands, release handles one by
+         * one instead */
+        int status = 0;
+        for (auto var_itr = ads_variables.begin();
+             var_itr != ads_variables.end(); var_itr++) {
+            rc = this->release_handle(*var_itr);
+            if (rc != 0) {
+                status = ads_rc_to_epicsads_error(rc);
+                if (status == EPICSADS_DISCONNECTED) {
+                    return status;
+                }
+                status = EPICSADS_NOT_RESOLVED;
+            }
+        }
+        return status;
+    } else if (rc != 0) {
+        if (ads_rc_to_epicsads_error(rc) == EPICSADS_DISCONNECTED) {
+            return EPICSADS_DISCONNECTED;
+        }
+        return EPICSADS_NOT_RESOLVED;
+    }
+
+    if (bytes_read < results.size() * sizeof(uint32_t)) {
+        LOG_ERR("sum unresolve response too short (%zu bytes)",
+                (size_t)bytes_read);
+        return EPICSADS_NOT_RESOLVED;
+    }
+
+    int status = 0;
+    for (size_t i = 0; i < nvars; i++) {
+        if (results[i] != 0) {
+            LOG_WARN("could not release handle of ADS variable '%s' (%u)",
+                     ads_variables[i]->addr->get_var_name().c_str(),
+                     results[i]);
+            status = EPICSADS_NOT_RESOLVED;
+        }
+    }
+
+    return status;
+}
+
 int Connection::unresolve_variables(
     const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
     std::lock_guard<epicsMutex> lock(this->mtx);
@@ -154,46 +619,177 @@ int Connection::unresolve_variables(
     bool ads_is_connected = this->is_connected();
     bool unresolve_errors = false;
 
-    for (size_t i = 0; i < ads_variables.size(); i++) {
-        std::shared_ptr<ADSVariable> ads_var = ads_variables[i];
+    /* ADS handles on the PLC can be released while ADS connection is
+     * established. Sum requests are sent to a single ADS port, so resolved
+     * variables are grouped by ADS port first. Variables resolved from the
+     * symbol table have no handle to release. */
+    std::map<uint16_t, std::vector<std::shared_ptr<ADSVariable>>>
+        vars_by_ads_port;
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        if ((*var_itr)->addr->is_resolved() == false) {
+            continue;
+        }
+        if ((*var_itr)->addr->has_handle() == false) {
+            (*var_itr)->addr->unresolve();
+            continue;
+        }
+        vars_by_ads_port[(*var_itr)->addr->get_ads_port()].push_back(*var_itr);
+    }
+
+    std::vector<std::shared_ptr<ADSVariable>> chunk;
+    for (auto port_itr = vars_by_ads_port.begin();
+         port_itr != vars_by_ads_port.end(); port_itr++) {
+        const std::vector<std::shared_ptr<ADSVariable>> &vars =
+            port_itr->second;
+
+        for (size_t start = 0; start < vars.size();
+             start += this->sum_operations_max_commands) {
+            size_t end =
+                std::min(vars.size(), start + this->sum_operations_max_commands);
+            chunk.assign(vars.begin() + start, vars.begin() + end);
+
+            /* Skip trying to unresolve variables on the ADS device if there
+             * is no connection, but still mark the input variables as
+             * unresolved. */
+            if (ads_is_connected == true) {
+                int rc = this->sum_unresolve_variables(port_itr->first, chunk);
+                if (rc == EPICSADS_DISCONNECTED) {
+                    ads_is_connected = false;
+                }
+                if (rc != 0) {
+                    unresolve_errors = true;
+                }
+            }
+
+            /* Variables are marked as unresolved if ADS communication is
+             * established or not. */
+            for (auto var_itr = chunk.begin(); var_itr != chunk.end();
+                 var_itr++) {
+                (*var_itr)->addr->unresolve();
+            }
+        }
+    }
+
+    if (ads_is_connected == false) {
+        return EPICSADS_DISCONNECTED;
+    } else if (unresolve_errors == true) {
+        return EPICSADS_NOT_RESOLVED;
+    }
+
+    return 0;
+}
+
+int Connection::add_notifications(
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
+    std::lock_guard<epicsMutex> lock(this->mtx);
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    this->delete_stale_notifications();
+
+    int status = 0;
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        std::shared_ptr<ADSVariable> ads_var = *var_itr;
+        if (ads_var->get_notification_user() != 0) {
+            continue;
+        }
+
         if (ads_var->addr->is_resolved() == false) {
+            status = EPICSADS_NOT_RESOLVED;
             continue;
         }
 
-        /* ADS handles on the PLC can be released while ADS connection is
-         * established. */
-        if (ads_is_connected == true) {
-            uint32_t handle = ads_var->addr->get_index_offset();
+        /* The notification is sent when the value changes on the ADS device,
+         * at most the notification delay [us] later. Delays are specified in
+         * 100 ns units. */
+        AdsNotificationAttrib attrib = {};
+        attrib.cbLength = ads_var->size();
+        attrib.nTransMode = ADSTRANS_SERVERONCHA;
+        attrib.nMaxDelay = ads_var->addr->get_notification_delay() * 10;
+        attrib.nCycleTime = 0;
+
+        uint32_t user = register_notification_user(ads_var, this->notification_listener);
+#ifdef USE_TC_ADS
+        ads_ui32 handle = 0;
+#else
+        uint32_t handle = 0;
+#endif
+        AmsAddr ams_addr = {this->remote_ams_netid,
+                            ads_var->addr->get_ads_port()};
+        long rc = AdsSyncAddDeviceNotificationReqEx(
+            this->ads_port,                    // ADS port
+            &ams_addr,                         // AMS address
+            ads_var->addr->get_index_group(),  // index group
+            ads_var->addr->get_index_offset(), // index offset
+            &attrib,                           // notification attributes
+            notification_callback,             // callback
+            user,                              // hUser
+            &handle);                          // notification handle
+        if (rc != 0) {
+            LOG_WARN("could not add notification for ADS variable '%s'",
+                     ads_var->addr->get_var_name().c_str());
+            unregister_notification_user(user);
+            status = ads_rc_to_epicsads_error(rc);
+            continue;
+        }
+
+        ads_var->set_notification(handle, user);
+    }
 
+    return status;
+}
+
+int Connection::delete_notifications(
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
+    std::lock_guard<epicsMutex> lock(this->mtx);
+
+    bool ads_is_connected = this->is_connected();
+    bool delete_errors = false;
+
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        std::shared_ptr<ADSVariable> ads_var = *var_itr;
+        if (ads_var->get_notification_user() == 0) {
+            continue;
+        }
+
+        bool deleted = false;
+        if (ads_is_connected == true) {
             AmsAddr ams_addr = {this->remote_ams_netid,
                                 ads_var->addr->get_ads_port()};
-            long rc = AdsSyncWriteReqEx(this->ads_port,         // AMS port
-                                        &ams_addr,              // AMS address
-                                        ADSIGRP_SYM_RELEASEHND, // index group
-                                        0,                      // index offset
-                                        sizeof(handle),         // buffer length
-                                        &handle);               // buffer
+            long rc = AdsSyncDelDeviceNotificationReqEx(
+                this->ads_port, &ams_addr, ads_var->get_notification_handle());
             if (rc != 0) {
-                /* Skip trying to unresolve variables on the ADS device if
-                 * there is no connection, but still mark the input variables
-                 * as unresolved. */
                 if (ads_rc_to_epicsads_error(rc) == EPICSADS_DISCONNECTED) {
                     ads_is_connected = false;
                 }
-
-                unresolve_errors = true;
+                delete_errors = true;
+            } else {
+                deleted = true;
             }
         }
 
-        /* Variables are marked as unresolved if ADS communication is
-         * established or not. */
-        ads_var->addr->unresolve();
+        /* The ADS device keeps the notification as long as the port it was
+         * registered through stays open */
+        if (deleted == false && this->kept_ads_port != 0) {
+            this->stale_notifications.push_back(
+                {ads_var->addr->get_ads_port(),
+                 ads_var->get_notification_handle()});
+        }
+
+        unregister_notification_user(ads_var->get_notification_user());
+        ads_var->set_notification(0, 0);
+        ads_var->invalidate_value();
     }
 
     if (ads_is_connected == false) {
         return EPICSADS_DISCONNECTED;
-    } else if (unresolve_errors == true) {
-        return EPICSADS_NOT_RESOLVED;
+    } else if (delete_errors == true) {
+        return EPICSADS_ERROR;
     }
 
     return 0;
@@ -245,3 +841,322 @@ int Connection::read_device_state(uint16_t *device_state, ADSState *ads_state) {
 
     return ads_rc_to_epicsads_error(rc);
 }
+
+int Connection::read_symbol_version(const uint16_t ads_port,
+                                    uint8_t *version) {
+    if (version == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    std::lock_guard<epicsMutex> lock(this->mtx);
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    long rc = AdsSyncReadReqEx2(this->ads_port,      // ADS port
+                                &ams_addr,           // AMS address
+                                ADSIGRP_SYM_VERSION, // index group
+                                0,                   // index offset
+                                sizeof(*version),    // read length
+                                version,             // read buffer
+                                &bytes_read);        // number of bytes read
+
+    return ads_rc_to_epicsads_error(rc);
+}
+
+int Connection::read_app_info(const uint16_t ads_port, AppInfo *info) {
+    if (info == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    /* Read by name, so no handles are needed */
+    static const char *const names[] = {
+        "TwinCAT_SystemInfoVarList._AppInfo.AppTimestamp",
+        "TwinCAT_SystemInfoVarList._AppInfo.OnlineChangeCnt"};
+    uint32_t *const values[] = {&info->app_timestamp, &info->online_changes};
+
+    std::lock_guard<epicsMutex> lock(this->mtx);
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+    for (size_t i = 0; i < 2; i++) {
+#ifdef USE_TC_ADS
+        ads_ui32 bytes_read = 0;
+#else
+        uint32_t bytes_read = 0;
+#endif
+        long rc = AdsSyncReadWriteReqEx2(
+            this->ads_port,        // ADS port
+            &ams_addr,             // AMS address
+            ADSIGRP_SYM_VALBYNAME, // index group
+            0,                     // index offset
+            sizeof(*values[i]),    // read length
+            values[i],             // read buffer
+            strlen(names[i]),      // write length
+            names[i],              // write buffer
+            &bytes_read);          // number of bytes read
+        if (rc != 0) {
+            return ads_rc_to_epicsads_error(rc);
+        } else if (bytes_read != sizeof(*values[i])) {
+            return EPICSADS_NO_DATA;
+        }
+    }
+
+    return 0;
+}
+
+int Connection::read_symbol_upload_info(const uint16_t ads_port,
+                                        SymbolUploadInfo *info) {
+    if (info == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    std::lock_guard<epicsMutex> lock(this->mtx);
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    long rc = AdsSyncReadReqEx2(this->ads_port,          // ADS port
+                                &ams_addr,               // AMS address
+                                ADSIGRP_SYM_UPLOADINFO2, // index group
+                                0,                       // index offset
+                                sizeof(*info),           // read length
+                                info,                    // read buffer
+                                &bytes_read); // number of bytes read
+    if (rc == 0 && bytes_read != sizeof(*info)) {
+        return EPICSADS_NO_DATA;
+    }
+
+    return ads_rc_to_epicsads_error(rc);
+}
+
+int Connection::upload_symbols(const uint16_t ads_port,
+                               std::vector<uint8_t> &data) {
+    SymbolUploadInfo info;
+    int status = this->read_symbol_upload_info(ads_port, &info);
+    if (status != 0) {
+        return status;
+    }
+
+    data.resize(info.symbols_size);
+    if (data.size() == 0) {
+        return 0;
+    }
+
+    std::lock_guard<epicsMutex> lock(this->mtx);
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    long rc = AdsSyncReadReqEx2(this->ads_port,     // ADS port
+                                &ams_addr,          // AMS address
+                                ADSIGRP_SYM_UPLOAD, // index group
+                                0,                  // index offset
+                                data.size(),        // read length
+                                data.data(),        // read buffer
+                                &bytes_read);       // number of bytes read
+    if (rc != 0) {
+        return ads_rc_to_epicsads_error(rc);
+    }
+
+    /* Symbols may have been removed since the size was read */
+    data.resize(bytes_read);
+
+    return 0;
+}
+
+int Connection::read_symbol_info(const uint16_t ads_port,
+                                 const std::string &name, SymbolInfo *info) {
+    if (info == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    /* The response is an AdsSymbolEntry: entry length, index group, index
+     * offset, size and data type are the first fields, followed by the
+     * symbol's name, type and comment */
+    std::vector<uint8_t> entry(symbol_info_max_size);
+
+    std::lock_guard<epicsMutex> lock(this->mtx);
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    long rc = AdsSyncReadWriteReqEx2(
+        this->ads_port,                   // ADS port
+        &ams_addr,                        // AMS address
+        ADSIGRP_SYM_INFOBYNAMEEX,         // index group
+        0,                                // index offset
+        entry.size(),                     // read length
+        entry.data(),                     // read data
+        name.size(),                      // write length
+        const_cast<char *>(name.c_str()), // write data
+        &bytes_read);                     // number of bytes read
+    if (rc != 0) {
+        return ads_rc_to_epicsads_error(rc);
+    }
+
+    if (bytes_read < 5 * sizeof(uint32_t)) {
+        return EPICSADS_NO_DATA;
+    }
+
+    memcpy(info, entry.data() + sizeof(uint32_t), sizeof(*info));
+
+    return 0;
+}
+
+int Connection::sum_read_symbol_infos(const uint16_t ads_port,
+                                      const std::vector<std::string> &names,
+                                      size_t first, size_t last,
+                                      std::vector<SymbolInfo> &infos,
+                                      std::vector<int> &statuses) {
+    const size_t nnames = last - first;
+    const size_t requests_size = nnames * sizeof(SumReadWriteRequestEntry);
+    const size_t results_size = nnames * sizeof(SumReadWriteResultEntry);
+
+    /* Write buffer: request entries, followed by symbol names */
+    size_t names_size = 0;
+    for (size_t i = first; i < last; i++) {
+        names_size += names[i].size();
+    }
+
+    std::vector<uint8_t> write_buffer;
+    std::vector<uint8_t> read_buffer;
+    try {
+        write_buffer.resize(requests_size + names_size);
+        read_buffer.resize(results_size + nnames * symbol_info_max_size);
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not allocate sum symbol info buffers: %s", ex.what());
+        return EPICSADS_ERROR;
+    }
+
+    SumReadWriteRequestEntry *requests =
+        (SumReadWriteRequestEntry *)write_buffer.data();
+    uint8_t *name_data = write_buffer.data() + requests_size;
+    for (size_t i = first; i < last; i++) {
+        requests[i - first] = {ADSIGRP_SYM_INFOBYNAMEEX, 0,
+                               (uint32_t)symbol_info_max_size,
+                               (uint32_t)names[i].size()};
+        memcpy(name_data, names[i].data(), names[i].size());
+        name_data += names[i].size();
+    }
+
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+    AmsAddr ams_addr = {this->remote_ams_netid, ads_port};
+    long rc = AdsSyncReadWriteReqEx2(
+        this->ads_port,          // ADS port
+        &ams_addr,               // AMS address
+        ADSIGRP_SUMUP_READWRITE, // index group
+        nnames, // offset; for SUMUP_READWRITE it is the number of commands
+        read_buffer.size(),  // read buffer size in bytes
+        read_buffer.data(),  // result codes, lengths and symbol entries
+        write_buffer.size(), // write buffer size in bytes
+        write_buffer.data(), // symbol info requests and names
+        &bytes_read);        // number of bytes read
+
+    if (rc == ADSERR_DEVICE_SRVNOTSUPP) {
+        /* ADS device doesn't support sum commands, read the symbol infos one
+         * by one instead */
+        for (size_t i = first; i < last; i++) {
+            statuses[i] =
+                this->read_symbol_info(ads_port, names[i], &infos[i]);
+        }
+        return 0;
+    } else if (rc != 0) {
+        LOG_WARN("could not read info of %zu symbols on ADS port %u", nnames,
+                 ads_port);
+        return ads_rc_to_epicsads_error(rc);
+    }
+
+    if (bytes_read < results_size) {
+        LOG_ERR("sum symbol info response too short (%zu bytes)",
+                (size_t)bytes_read);
+        return EPICSADS_ERROR;
+    }
+
+    /* Read buffer: result entries, followed by the AdsSymbolEntry of each
+     * symbol that was found (see read_symbol_info()) */
+    const SumReadWriteResultEntry *results =
+        (const SumReadWriteResultEntry *)read_buffer.data();
+    const uint8_t *data = read_buffer.data() + results_size;
+    const uint8_t *data_end = read_buffer.data() + bytes_read;
+
+    for (size_t i = first; i < last; i++) {
+        const SumReadWriteResultEntry &result = results[i - first];
+
+        if (result.length > (size_t)(data_end - data)) {
+            LOG_ERR("sum symbol info response is truncated");
+            return EPICSADS_ERROR;
+        }
+        const uint8_t *entry_data = data;
+        data += result.length;
+
+        if (result.result != 0) {
+            statuses[i] = ads_rc_to_epicsads_error(result.result);
+        } else if (result.length < 5 * sizeof(uint32_t)) {
+            statuses[i] = EPICSADS_NO_DATA;
+        } else {
+            memcpy(&infos[i], entry_data + sizeof(uint32_t), sizeof(infos[i]));
+            statuses[i] = 0;
+        }
+    }
+
+    return 0;
+}
+
+int Connection::read_symbol_infos(const uint16_t ads_port,
+                                  const std::vector<std::string> &names,
+                                  std::vector<SymbolInfo> &infos,
+                                  std::vector<int> &statuses) {
+    std::lock_guard<epicsMutex> lock(this->mtx);
+
+    infos.assign(names.size(), SymbolInfo());
+    statuses.assign(names.size(), EPICSADS_DISCONNECTED);
+
+    if (this->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    int status = 0;
+    for (size_t start = 0; start < names.size();
+         start += this->sum_operations_max_commands) {
+        size_t end =
+            std::min(names.size(), start + this->sum_operations_max_commands);
+
+        int rc = this->sum_read_symbol_infos(ads_port, names, start, end,
+                                             infos, statuses);
+        if (rc != 0) {
+            for (size_t i = start; i < end; i++) {
+                statuses[i] = rc;
+            }
+            status = rc;
+        }
+    }
+
+    return status;
+}
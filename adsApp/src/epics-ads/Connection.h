@@ -5,6 +5,7 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -19,11 +20,63 @@
 
 #include "Variable.h"
 
+/* Sizes of the symbol table of an ADS device, as returned by the
+ * ADSIGRP_SYM_UPLOADINFO2 request */
+struct SymbolUploadInfo {
+    uint32_t num_symbols;
+    uint32_t symbols_size; /* bytes returned by ADSIGRP_SYM_UPLOAD */
+    uint32_t num_datatypes;
+    uint32_t datatypes_size;
+    uint32_t max_dynamic_symbols;
+    uint32_t used_dynamic_symbols;
+};
+
+/* Location of a symbol, as returned by the ADSIGRP_SYM_INFOBYNAMEEX
+ * request */
+struct SymbolInfo {
+    uint32_t index_group;
+    uint32_t index_offset;
+    uint32_t size;      /* Size in bytes */
+    uint32_t data_type; /* ADS data type ID, e.g. ADST_INT16 */
+};
+
+/* Application info of a TwinCAT 3 PLC runtime */
+struct AppInfo {
+    uint32_t app_timestamp;  /* _AppInfo.AppTimestamp, seconds since 1970 */
+    uint32_t online_changes; /* _AppInfo.OnlineChangeCnt */
+};
+
 class Connection {
   protected:
     AmsNetId remote_ams_netid;  /* Remote ADS device AMS net ID */
     std::string remote_address; /* Remote ADS device address */
     long ads_port = 0;          /* ADS connection handle */
+
+    /* Additional ADS ports opened for parallel sum-reads. Lane 0 uses the
+     * connection's ADS port, lane N uses lane_ads_ports[N - 1]. */
+    std::vector<long> lane_ads_ports;
+
+    /* ADS ports kept open by disconnect(true) and reused by the next
+     * connect(). The ADS device binds variable handles to the client AMS
+     * address, so keeping the ports keeps the handles usable. */
+    long kept_ads_port = 0;
+    std::vector<long> kept_lane_ads_ports;
+
+    /* Notifications registered through the kept ADS port that could not be
+     * deleted on the ADS device because the connection was lost. They are
+     * deleted by add_notifications() once the kept port is reused, so the
+     * device doesn't keep sending them. */
+    struct StaleNotification {
+        uint16_t ads_port; /* ADS port of the device */
+        uint32_t handle;   /* notification handle */
+    };
+    std::vector<StaleNotification> stale_notifications;
+
+    /* Close the ADS ports kept by disconnect(true) */
+    void close_kept_ports();
+
+    /* Delete the stale notifications on the ADS device */
+    void delete_stale_notifications();
     uint16_t device_read_ads_port;
     bool connected = false;
 
@@ -38,6 +91,41 @@ class Connection {
      */
     unsigned int sum_operations_max_commands = 500;
 
+    /* Size of the buffer for the ADSIGRP_SYM_INFOBYNAMEEX response, which
+     * includes the symbol's type name and comment */
+    static const size_t symbol_info_max_size = 4096;
+
+    /* Called by the ADS library's notification thread after a value received
+     * by an ADS device notification is stored. */
+    std::function<void()> notification_listener;
+
+    /* Request a handle for a single ADS variable. Returns ADS return code. */
+    long request_handle(std::shared_ptr<ADSVariable> ads_variable,
+                        uint32_t *handle);
+
+    /* Resolve ADS_VARIABLES, which all use ADS_PORT, with a single ADS sum
+     * read-write request. */
+    int sum_resolve_variables(
+        const uint16_t ads_port,
+        const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
+
+    /* Release the handle of a single ADS variable. Returns ADS return code. */
+    long release_handle(std::shared_ptr<ADSVariable> ads_variable);
+
+    /* Release handles of ADS_VARIABLES, which all use ADS_PORT, with a single
+     * ADS sum write request. */
+    int sum_unresolve_variables(
+        const uint16_t ads_port,
+        const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
+
+    /* Read the symbol info of NAMES[FIRST, LAST), which all use ADS_PORT,
+     * with a single ADS sum read-write request (see read_symbol_infos()) */
+    int sum_read_symbol_infos(const uint16_t ads_port,
+                              const std::vector<std::string> &names,
+                              size_t first, size_t last,
+                              std::vector<SymbolInfo> &infos,
+                              std::vector<int> &statuses);
+
   public:
     /* True if ADS connection is established */
     bool is_connected();
@@ -48,6 +136,14 @@ class Connection {
     /* ADS port for the open connection, as returned by AdsPortOpenEx() */
     long get_ads_port();
 
+    /* Number of lanes, i.e. ADS ports that can be used concurrently */
+    unsigned int get_num_lanes();
+
+    /* ADS port for LANE. Lane 0 and lanes out of range share the
+     * connection's ADS port, which must be used while holding `mtx`. Ports of
+     * other lanes are used by a single thread and need no locking. */
+    long get_lane_ads_port(unsigned int lane);
+
     /* Connection mutex to use when calling class methods in multiple threads */
     epicsMutex mtx;
 
@@ -55,11 +151,19 @@ class Connection {
     ~Connection();
 
     void set_local_ams_id(const AmsNetId ams_id);
-    int connect(const AmsNetId ams_id, const std::string address, const uint16_t deviceReadAdsPort);
 
-    /* Disconnect from the ADS device, i.e. close the ADS port and remove the
-     * remote AMS route. */
-    int disconnect();
+    /* Set the maximum number of commands in a single ADS sum request */
+    void set_sum_operations_max_commands(const unsigned int max_commands);
+    /* Connect to the ADS device, opening NUM_LANES ADS ports in total. The
+     * ports kept by disconnect(true) are reused if there are as many. */
+    int connect(const AmsNetId ams_id, const std::string address,
+                const uint16_t deviceReadAdsPort,
+                const unsigned int num_lanes = 1);
+
+    /* Disconnect from the ADS device, i.e. close the ADS ports and remove the
+     * remote AMS route. With KEEP_PORTS, the ADS ports are kept open for the
+     * next connect(), so that the variable handles stay valid. */
+    int disconnect(const bool keep_ports = false);
 
     /* Sets the connection state as 'disconnected', without calling any ADS
      * disconnect/port close functions.
@@ -75,7 +179,8 @@ class Connection {
     int resolve_variable(std::shared_ptr<ADSVariable> ads_variable);
 
     /* Resolve (acquire handles) for ADS variables specified with a symbolic
-     * name. */
+     * name. Handles are requested with ADS sum read-write requests of up to
+     * `sum_operations_max_commands` variables. */
     int resolve_variables(
         const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
 
@@ -84,10 +189,31 @@ class Connection {
     int unresolve_variable(std::shared_ptr<ADSVariable> ads_variable);
 
     /* Unresolve (release handles) for ADS variables specified with a symbolic
-     * name. */
+     * name. Handles are released with ADS sum write requests of up to
+     * `sum_operations_max_commands` variables. */
     int unresolve_variables(
         const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
 
+    /* Register ADS device notifications for ADS_VARIABLES, which must be
+     * resolved. Values received by notifications are stored in the variables
+     * (see ADSVariable::store_notification_value()). Notifications that were
+     * forgotten by delete_notifications() while disconnected are deleted on
+     * the ADS device first. */
+    int add_notifications(
+        const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
+
+    /* Delete ADS device notifications registered for ADS_VARIABLES. The
+     * notifications are deleted on the ADS device if the connection is
+     * established, otherwise they are forgotten and, if the ADS port is kept
+     * by disconnect(true), deleted by the next add_notifications(). */
+    int delete_notifications(
+        const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
+
+    /* Set LISTENER, which is called whenever a value is received by an ADS
+     * device notification. Only notifications added afterwards use it. The
+     * listener must not block. */
+    void set_notification_listener(std::function<void()> listener);
+
     /* Read ADS device information into DEVICE_INFO of size SIZE_DEVICE_INFO
      * bytes and ADS_VERSION. DEVICE_INFO should be at least 16 bytes long. */
     int read_device_info(char *device_info, size_t size_device_info,
@@ -95,6 +221,40 @@ class Connection {
 
     /* Read ADS device and protocol state. */
     int read_device_state(uint16_t *device_state, ADSState *ads_state);
+
+    /* Read the symbol version of the ADS device at ADS_PORT into VERSION. The
+     * symbol version changes when the symbols (and thus variable handles) of
+     * the device become invalid, e.g. after a PLC program download. */
+    int read_symbol_version(const uint16_t ads_port, uint8_t *version);
+
+    /* Read the application info of the TwinCAT 3 PLC at ADS_PORT into INFO.
+     * It changes when a PLC program is downloaded or changed online, even if
+     * the 8-bit symbol version happens to be the same. Other ADS devices
+     * don't provide it. */
+    int read_app_info(const uint16_t ads_port, AppInfo *info);
+
+    /* Read the size of the symbol table of the ADS device at ADS_PORT */
+    int read_symbol_upload_info(const uint16_t ads_port,
+                                SymbolUploadInfo *info);
+
+    /* Upload the symbol table of the ADS device at ADS_PORT into DATA. DATA
+     * is resized to the size reported by read_symbol_upload_info(). */
+    int upload_symbols(const uint16_t ads_port, std::vector<uint8_t> &data);
+
+    /* Read the index group, index offset and size of the symbol NAME of the
+     * ADS device at ADS_PORT into INFO, without requesting a handle. NAME may
+     * address an element, e.g. MAIN.values[3]. */
+    int read_symbol_info(const uint16_t ads_port, const std::string &name,
+                         SymbolInfo *info);
+
+    /* Read the symbol info of each of NAMES of the ADS device at ADS_PORT
+     * into INFOS, with ADS sum read-write requests of up to
+     * `sum_operations_max_commands` names. STATUSES holds 0 for each name
+     * whose info was read, or an EPICSADS_* error code. */
+    int read_symbol_infos(const uint16_t ads_port,
+                          const std::vector<std::string> &names,
+                          std::vector<SymbolInfo> &infos,
+                          std::vector<int> &statuses);
 };
 
 #endif /* CONNECTION_H */
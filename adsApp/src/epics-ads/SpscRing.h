@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: 2022 Cosylab d.d.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Lock-free ring of DEPTH slots passing elements from a single producer
+ * thread to a single consumer thread.
+ *
+ * The slots are allocated up front and reused: the producer fills the slot
+ * returned by producer_slot() in place and makes it visible with push(), the
+ * consumer reads the slot returned by consumer_slot() and releases it with
+ * pop(). A slot is owned by one thread at a time, so elements need no locking
+ * of their own. */
+template <typename T> class SpscRing {
+  protected:
+    std::vector<T> slots;
+
+    /* Number of elements pushed and popped so far. The producer only writes
+     * `head`, the consumer only writes `tail`. */
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+
+  public:
+    /* Ring of DEPTH slots (at least 1), each initialized to a copy of
+     * INITIAL */
+    SpscRing(const size_t depth, const T &initial)
+        : slots(depth > 0 ? depth : 1, initial), head(0), tail(0) {}
+
+    size_t capacity() const { return this->slots.size(); }
+
+    /* Number of elements pushed, but not popped yet */
+    size_t size() const {
+        return this->head.load(std::memory_order_acquire) -
+               this->tail.load(std::memory_order_acquire);
+    }
+
+    /* Free slot to fill before push(), or nullptr if the ring is full.
+     * Producer only. */
+    T *producer_slot() {
+        uint64_t h = this->head.load(std::memory_order_relaxed);
+        if (h - this->tail.load(std::memory_order_acquire) >=
+            this->slots.size()) {
+            return nullptr;
+        }
+        return &this->slots[h % this->slots.size()];
+    }
+
+    /* Make the slot returned by producer_slot() visible to the consumer.
+     * Producer only. */
+    void push() {
+        this->head.store(this->head.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    }
+
+    /* Oldest pushed element, or nullptr if the ring is empty. Consumer
+     * only. */
+    T *consumer_slot() {
+        uint64_t t = this->tail.load(std::memory_order_relaxed);
+        if (t == this->head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &this->slots[t % this->slots.size()];
+    }
+
+    /* Release the slot returned by consumer_slot() to the producer. Consumer
+     * only. */
+    void pop() {
+        this->tail.store(this->tail.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_release);
+    }
+};
+
+#endif /* SPSCRING_H */
@@ -3,13 +3,28 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdexcept>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EPICSADS_USE_SSE2
+#endif
 
 #include "err.h"
 #include "Variable.h"
 #include "SumReadBuffer.h"
 
+static void diff_blocks(const uint8_t *a, const uint8_t *b, size_t size,
+                        uint64_t *changed_blocks);
+static bool any_bit_set(const uint64_t *bitmap, size_t first, size_t last);
+
 unsigned int SumReadBuffer::get_num_variables() {
     return this->variables.size();
 }
@@ -29,14 +44,37 @@ bool SumReadBuffer::at_capacity() {
            (this->next_result_offset >= this->max_nvariables);
 }
 
-uint8_t *SumReadBuffer::get_buffer() { return this->buffer; }
+uint8_t *SumReadBuffer::ring_buffer(uint64_t gen) {
+    return this->buffer + (gen % this->ring_size) * this->buffer_size;
+}
+
+uint8_t *SumReadBuffer::get_buffer() {
+    if (this->buffer == nullptr) {
+        return nullptr;
+    }
+
+    return this->ring_buffer(
+        this->generation.load(std::memory_order_acquire));
+}
 
 uint8_t *SumReadBuffer::get_buffer_data_section() {
-    return this->buffer + this->start_of_data_offset();
+    if (this->buffer == nullptr) {
+        return nullptr;
+    }
+
+    return this->get_buffer() + this->start_of_data_offset();
 }
 
-SumReadBuffer::SumReadBuffer(const uint16_t max_nvariables)
-    : rwlock(RWLock::prefer_writer) {
+uint8_t *SumReadBuffer::get_receive_buffer() {
+    if (this->buffer == nullptr) {
+        return nullptr;
+    }
+
+    return this->ring_buffer(
+        this->generation.load(std::memory_order_relaxed) + 1);
+}
+
+SumReadBuffer::SumReadBuffer(const uint16_t max_nvariables) : generation(0) {
     if (max_nvariables == 0) {
         throw std::invalid_argument("max_nvariables must be larger that zero");
     }
@@ -56,11 +94,6 @@ SumReadBuffer::SumReadBuffer(const uint16_t max_nvariables,
 }
 
 SumReadBuffer::~SumReadBuffer() {
-    if (this->prev_data_buffer != nullptr) {
-        free(this->prev_data_buffer);
-        this->prev_data_buffer = nullptr;
-    }
-
     if (this->buffer != nullptr) {
         free(this->buffer);
         this->buffer = nullptr;
@@ -98,7 +131,8 @@ int SumReadBuffer::add_variable(std::shared_ptr<ADSVariable> variable) {
     /* Store information about where the variables' corresponding data can be
      * found in the buffer */
     BufferDataPosition bdp = {this, this->next_result_offset,
-                              this->next_data_offset};
+                              this->next_data_offset,
+                              (uint32_t)this->variables.size() - 1};
     variable->set_buffer_reader(bdp);
 
     this->next_result_offset++;
@@ -121,18 +155,24 @@ int SumReadBuffer::read_data(uint16_t offset_result, size_t offset_data,
         return EPICSADS_OUT_OF_RANGE;
     }
 
-    this->rwlock.lock_read();
-
-    /* Return codes block is stored at the beginning of the buffer. */
-    uint32_t *buffer_rc = ((uint32_t *)this->buffer) + offset_result;
-    *result = *buffer_rc;
-
-    /* Data is stored in the buffer after the return codes block. */
-    uint8_t *buffer_data =
-        this->buffer + this->start_of_data_offset() + offset_data;
-    memcpy(data, buffer_data, data_size);
-
-    this->rwlock.unlock_read();
+    /* The writer receives into the buffer following the published one, so
+     * the buffer being copied is only reused after another ring_size - 1
+     * publications. */
+    uint64_t gen;
+    do {
+        gen = this->generation.load(std::memory_order_acquire);
+        const uint8_t *front = this->ring_buffer(gen);
+
+        /* Return codes block is stored at the beginning of the buffer. Data
+         * is stored in the buffer after the return codes block. */
+        memcpy(result, front + offset_result * this->result_size,
+               this->result_size);
+        memcpy(data, front + this->start_of_data_offset() + offset_data,
+               data_size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (this->generation.load(std::memory_order_relaxed) - gen >=
+             this->ring_size - 1);
 
     return 0;
 }
@@ -146,38 +186,270 @@ int SumReadBuffer::initialize_buffer() {
         return EPICSADS_INV_CALL;
     }
 
-    this->buffer = (uint8_t *)calloc(this->buffer_size, sizeof(uint8_t));
+    int rc = this->allocate_ring();
+    if (rc != 0) {
+        return rc;
+    }
+
+    this->buffer_initialized = true;
+
+    return 0;
+}
+
+int SumReadBuffer::allocate_ring() {
+    if (this->buffer != nullptr) {
+        free(this->buffer);
+        this->buffer = nullptr;
+    }
+
+    this->buffer =
+        (uint8_t *)calloc(this->ring_size * this->buffer_size, sizeof(uint8_t));
     if (this->buffer == nullptr) {
         return EPICSADS_ERROR;
     }
+    this->generation.store(0, std::memory_order_relaxed);
 
-    this->prev_data_buffer =
-        (uint8_t *)calloc(this->buffer_size, sizeof(uint8_t));
-    // TODO: cheap optimization is to not allocate it when there aren't any
-    // notify-on-update variables
-    if (this->prev_data_buffer == nullptr) {
+    size_t nblocks =
+        (this->buffer_size + change_block_size - 1) / change_block_size;
+    try {
+        this->changed_blocks.assign((nblocks + 63) / 64, 0);
+        this->updated_variables.assign(
+            (this->get_num_variables() + 63) / 64, 0);
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not allocate change detection bitmaps: %s", ex.what());
         free(this->buffer);
         this->buffer = nullptr;
         return EPICSADS_ERROR;
     }
 
-    this->buffer_initialized = true;
-
     return 0;
 }
 
-void SumReadBuffer::save_buffer() {
-    if (this->prev_data_buffer == nullptr) {
+int SumReadBuffer::plan_ranges(const long merge_gap) {
+    if (this->buffer_initialized == false) {
+        return EPICSADS_NOT_INITIALIZED;
+    }
+
+    /* Variables are read in the order they were added, except for the ones
+     * merged into ranges, which are sorted by their address */
+    std::vector<size_t> order;
+    std::vector<size_t> mergeable;
+    for (size_t i_var = 0; i_var < this->variables.size(); i_var++) {
+        const std::shared_ptr<ADSAddress> &addr = this->variables[i_var]->addr;
+        if (addr->is_resolved() == false) {
+            return EPICSADS_NOT_RESOLVED;
+        }
+
+        if (merge_gap >= 0 && addr->has_handle() == false) {
+            mergeable.push_back(i_var);
+        } else {
+            order.push_back(i_var);
+        }
+    }
+    std::sort(mergeable.begin(), mergeable.end(),
+              [this](size_t a, size_t b) {
+                  const ADSAddress &addr_a = *this->variables[a]->addr;
+                  const ADSAddress &addr_b = *this->variables[b]->addr;
+                  if (addr_a.get_index_group() != addr_b.get_index_group()) {
+                      return addr_a.get_index_group() <
+                             addr_b.get_index_group();
+                  }
+                  return addr_a.get_index_offset() <
+                         addr_b.get_index_offset();
+              });
+
+    std::vector<ReadRange> new_ranges;
+    std::vector<BufferDataPosition> positions(this->variables.size());
+    std::vector<size_t> range_data_offsets;
+    size_t data_offset = 0;
+
+    /* Variables that can't be merged are read by their own entry */
+    for (auto order_itr = order.begin(); order_itr != order.end();
+         order_itr++) {
+        const std::shared_ptr<ADSVariable> &var = this->variables[*order_itr];
+        new_ranges.push_back({var->addr->get_index_group(),
+                              var->addr->get_index_offset(), var->size()});
+        range_data_offsets.push_back(data_offset);
+        data_offset += var->size();
+    }
+
+    /* Merge variables whose data is at most merge_gap bytes apart */
+    std::vector<size_t> var_ranges(this->variables.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        var_ranges[order[i]] = i;
+    }
+    for (auto merge_itr = mergeable.begin(); merge_itr != mergeable.end();
+         merge_itr++) {
+        const std::shared_ptr<ADSVariable> &var = this->variables[*merge_itr];
+        uint32_t group = var->addr->get_index_group();
+        uint64_t start = var->addr->get_index_offset();
+        uint64_t end = start + var->size();
+
+        bool merged = false;
+        if (new_ranges.size() > order.size()) {
+            ReadRange &range = new_ranges.back();
+            uint64_t range_end = (uint64_t)range.index_offset + range.length;
+            if (range.index_group == group &&
+                start <= range_end + (uint64_t)merge_gap &&
+                std::max(end, range_end) - range.index_offset <= UINT32_MAX) {
+                if (end > range_end) {
+                    data_offset += end - range_end;
+                    range.length = end - range.index_offset;
+                }
+                merged = true;
+            }
+        }
+
+        if (merged == false) {
+            new_ranges.push_back({group, (uint32_t)start, var->size()});
+            range_data_offsets.push_back(data_offset);
+            data_offset += var->size();
+        }
+        var_ranges[*merge_itr] = new_ranges.size() - 1;
+    }
+
+    for (size_t i_var = 0; i_var < this->variables.size(); i_var++) {
+        size_t i_range = var_ranges[i_var];
+        positions[i_var] = {
+            this, (uint32_t)i_range,
+            range_data_offsets[i_range] +
+                (this->variables[i_var]->addr->get_index_offset() -
+                 new_ranges[i_range].index_offset),
+            (uint32_t)i_var};
+    }
+
+    this->ranges.swap(new_ranges);
+    this->next_result_offset = this->ranges.size();
+    this->next_data_offset = data_offset;
+    this->buffer_size =
+        this->ranges.size() * this->result_size + this->next_data_offset;
+    for (size_t i_var = 0; i_var < this->variables.size(); i_var++) {
+        this->variables[i_var]->set_buffer_reader(positions[i_var]);
+    }
+
+    this->buffer_state = SumReadBufferState::Invalid;
+    int rc = this->allocate_ring();
+    if (rc != 0) {
+        this->buffer_initialized = false;
+    }
+
+    return rc;
+}
+
+const std::vector<SumReadBuffer::ReadRange> &SumReadBuffer::get_ranges() {
+    return this->ranges;
+}
+
+void SumReadBuffer::publish() {
+    if (this->buffer == nullptr) {
         return;
     }
 
-    this->rwlock.lock_write();
-    memcpy(this->prev_data_buffer, this->buffer, this->buffer_size);
-    this->rwlock.unlock_write();
+    uint64_t gen = this->generation.load(std::memory_order_relaxed);
+
+    /* Data left over from a failed sum-read can't be used as reference */
+    if (this->buffer_state == SumReadBufferState::Valid) {
+        this->detect_changes(this->ring_buffer(gen + 1),
+                             this->ring_buffer(gen));
+    } else {
+        std::fill(this->updated_variables.begin(),
+                  this->updated_variables.end(), ~(uint64_t)0);
+    }
+
+    this->generation.store(gen + 1, std::memory_order_release);
+    /* Order the publication before the next receive into the ring, which may
+     * overwrite a buffer still being copied by a lagging reader. */
+    std::atomic_thread_fence(std::memory_order_release);
+
+    this->buffer_state = SumReadBufferState::Valid;
+}
+
+void SumReadBuffer::invalidate() {
+    uint64_t mark = 0;
+    if (this->buffer_state == SumReadBufferState::Valid) {
+        mark = ~(uint64_t)0;
+    }
+    std::fill(this->updated_variables.begin(), this->updated_variables.end(),
+              mark);
+
+    this->buffer_state = SumReadBufferState::Invalid;
+}
+
+void SumReadBuffer::detect_changes(const uint8_t *data,
+                                   const uint8_t *reference) {
+    std::fill(this->changed_blocks.begin(), this->changed_blocks.end(), 0);
+    std::fill(this->updated_variables.begin(), this->updated_variables.end(),
+              0);
+
+    diff_blocks(data, reference, this->buffer_size,
+                this->changed_blocks.data());
+
+    bool any_changes = false;
+    for (size_t i = 0; i < this->changed_blocks.size(); i++) {
+        if (this->changed_blocks[i] != 0) {
+            any_changes = true;
+            break;
+        }
+    }
+    if (any_changes == false) {
+        return;
+    }
+
+    /* Map changed blocks to variables. A block can be shared by neighbouring
+     * variables, so the variable's own bytes are compared to make the result
+     * exact. */
+    const size_t data_offset = this->start_of_data_offset();
+    for (size_t i_var = 0; i_var < this->variables.size(); i_var++) {
+        const BufferDataPosition bdp =
+            this->variables[i_var]->get_buffer_reader();
+        const size_t off_result = bdp.off_result * this->result_size;
+        const size_t off_data = data_offset + bdp.off_data;
+        const size_t data_size = this->variables[i_var]->size();
+
+        bool updated = false;
+        if (any_bit_set(this->changed_blocks.data(),
+                        off_result / change_block_size,
+                        (off_result + this->result_size - 1) /
+                            change_block_size) &&
+            memcmp(data + off_result, reference + off_result,
+                   this->result_size) != 0) {
+            updated = true;
+        } else if (data_size > 0 &&
+                   any_bit_set(this->changed_blocks.data(),
+                               off_data / change_block_size,
+                               (off_data + data_size - 1) /
+                                   change_block_size) &&
+                   memcmp(data + off_data, reference + off_data, data_size) !=
+                       0) {
+            updated = true;
+        }
+
+        if (updated == true) {
+            this->updated_variables[bdp.index / 64] |=
+                ((uint64_t)1 << (bdp.index % 64));
+        }
+    }
+}
+
+bool SumReadBuffer::is_updated(uint32_t index) {
+    if (index >= this->variables.size()) {
+        return false;
+    }
+
+    return (this->updated_variables[index / 64] >> (index % 64)) & 1;
+}
+
+void SumReadBuffer::get_updated_variables(
+    std::vector<std::shared_ptr<ADSVariable>> &updated) {
+    for (size_t i_var = 0; i_var < this->variables.size(); i_var++) {
+        if (this->is_updated(i_var)) {
+            updated.push_back(this->variables[i_var]);
+        }
+    }
 }
 
 size_t SumReadBuffer::results_size() {
-    return this->get_num_variables() * this->result_size;
+    return this->next_result_offset * this->result_size;
 }
 
 size_t SumReadBuffer::data_size() {
@@ -185,3 +457,72 @@ size_t SumReadBuffer::data_size() {
 }
 
 size_t SumReadBuffer::start_of_data_offset() { return this->results_size(); }
+
+/* Compare SIZE bytes of A and B and set a bit in CHANGED_BLOCKS for every
+ * SumReadBuffer::change_block_size block that differs. Uses AVX2 or SSE2 when
+ * the compiler targets them, otherwise compares 64-bit words. */
+static void diff_blocks(const uint8_t *a, const uint8_t *b, size_t size,
+                        uint64_t *changed_blocks) {
+    const size_t block_size = SumReadBuffer::change_block_size;
+    const size_t nblocks = size / block_size;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 2 <= nblocks; i += 2) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i * block_size));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i * block_size));
+        uint32_t eq = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (eq != 0xFFFFFFFFu) {
+            if ((eq & 0xFFFFu) != 0xFFFFu) {
+                changed_blocks[i / 64] |= ((uint64_t)1 << (i % 64));
+            }
+            if ((eq >> 16) != 0xFFFFu) {
+                changed_blocks[(i + 1) / 64] |= ((uint64_t)1 << ((i + 1) % 64));
+            }
+        }
+    }
+#endif
+
+#if defined(__AVX2__) || defined(EPICSADS_USE_SSE2)
+    for (; i < nblocks; i++) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i * block_size));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i * block_size));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) {
+            changed_blocks[i / 64] |= ((uint64_t)1 << (i % 64));
+        }
+    }
+#else
+    for (; i < nblocks; i++) {
+        uint64_t wa[2], wb[2];
+        memcpy(wa, a + i * block_size, sizeof(wa));
+        memcpy(wb, b + i * block_size, sizeof(wb));
+        if (((wa[0] ^ wb[0]) | (wa[1] ^ wb[1])) != 0) {
+            changed_blocks[i / 64] |= ((uint64_t)1 << (i % 64));
+        }
+    }
+#endif
+
+    /* Trailing bytes that don't fill a whole block */
+    const size_t tail = size % block_size;
+    if (tail != 0 &&
+        memcmp(a + nblocks * block_size, b + nblocks * block_size, tail) != 0) {
+        changed_blocks[nblocks / 64] |= ((uint64_t)1 << (nblocks % 64));
+    }
+}
+
+/* True if any bit between FIRST and LAST (inclusive) is set in BITMAP. */
+static bool any_bit_set(const uint64_t *bitmap, size_t first, size_t last) {
+    for (size_t i = first; i <= last;) {
+        uint64_t word = bitmap[i / 64];
+        if (word == 0) {
+            i = (i / 64 + 1) * 64;
+            continue;
+        }
+        if ((word >> (i % 64)) & 1) {
+            return true;
+        }
+        i++;
+    }
+
+    return false;
+}
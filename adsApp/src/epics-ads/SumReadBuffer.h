@@ -5,10 +5,11 @@
 #ifndef SUMREADBUFFER_H
 #define SUMREADBUFFER_H
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <vector>
 // #include "ADSPortDriver.h"
-#include "RWLock.h"
 #include "autoparamHandler.h"
 
 /* Defined in Variable.h, which includes this header file (prevent cyclic
@@ -16,6 +17,15 @@
 class ADSVariable;
 
 class SumReadBuffer {
+  public:
+    /* Contiguous memory range of the ADS device, read by a single entry of
+     * the ADS sum-read request */
+    struct ReadRange {
+        uint32_t index_group;
+        uint32_t index_offset;
+        uint32_t length;
+    };
+
   protected:
     /* Variables added to this buffer */
     std::vector<std::shared_ptr<ADSVariable>> variables;
@@ -24,18 +34,49 @@ class SumReadBuffer {
     size_t max_data_size_soft_limit =
         1000000; /* Maximum soft limit for data segment size */
     uint16_t next_result_offset =
-        0; /* Buffer index for the next added result */
+        0; /* Buffer index for the next added result, i.e. number of read
+              results (ranges) */
     size_t next_data_offset =
         0; /* Buffer byte offset from the beginning of the data block */
     size_t buffer_size = 0; /* Buffer size in bytes (results and data blocks) */
 
-    /* Buffer contains result code and data elements. Result codes are stored
+    /* Storage for a ring of ring_size buffers of buffer_size bytes. Each
+     * buffer contains result code and data elements. Result codes are stored
      * at the beginning of the buffer and are all of the same size. Data
-     * elements are stored after the results block and are of varying size. */
+     * elements are stored after the results block and are of varying size.
+     *
+     * The buffer at `generation` holds the latest published sum-read data and
+     * is never written to. The ADS sum-read response is received into the
+     * next buffer in the ring, which becomes visible to readers when
+     * `generation` is incremented by publish(). */
     uint8_t *buffer = nullptr;
     bool buffer_initialized = false;
 
-    uint8_t *prev_data_buffer = nullptr;
+    /* Generation of the published buffer; only incremented by publish(). It is
+     * 64 bits wide, so it never wraps and gen % ring_size always selects the
+     * next slot. */
+    std::atomic<uint64_t> generation;
+
+    /* Buffer in the ring holding data of generation GEN */
+    uint8_t *ring_buffer(uint64_t gen);
+
+    /* Bitmap of change_block_size blocks of the received data that differ
+     * from the published data, filled by detect_changes(). */
+    std::vector<uint64_t> changed_blocks;
+
+    /* Ranges read into the buffer, set by plan_ranges() */
+    std::vector<ReadRange> ranges;
+
+    /* Allocate the ring of buffers and the change detection bitmaps */
+    int allocate_ring();
+
+    /* Bitmap of variables (indexed by BufferDataPosition::index) whose result
+     * code or data changed in the latest publish(). */
+    std::vector<uint64_t> updated_variables;
+
+    /* Mark variables whose result code or data differ between DATA and
+     * REFERENCE buffers. */
+    void detect_changes(const uint8_t *data, const uint8_t *reference);
 
     size_t results_size();         /* Size of results in bytes */
     size_t data_size();            /* Size of data in bytes */
@@ -52,12 +93,16 @@ class SumReadBuffer {
                   const size_t data_size_soft_limit);
     ~SumReadBuffer();
 
-    /* R/W lock should be used when accessing the underlying data buffer through
-     * get_buffer() and get_data_buffer_data_section(). */
-    RWLock rwlock;
+    /* Number of buffers in the ring. A reader copying from the published
+     * buffer is only overtaken by the writer after ring_size - 1 further
+     * publications. */
+    static const uint32_t ring_size = 3;
 
     static const size_t result_size = sizeof(uint32_t);
 
+    /* Granularity of the word-wise buffer comparison in detect_changes() */
+    static const size_t change_block_size = 16;
+
     unsigned int get_num_variables(); /* Number of variables added */
     unsigned int get_max_variables(); /* Maximum number of variables allowd */
     size_t get_max_data_size_soft_limit(); /* Soft limit for maximum data
@@ -66,22 +111,22 @@ class SumReadBuffer {
     bool is_initialized();                 /* True if buffer is initialized */
     bool at_capacity(); /* True if no more variables can be added to buffer */
 
-    /* Pointer to underlying buffer storage. Code performing ADS sum read
-     * writes to this buffer.
+    /* Pointer to underlying published buffer storage.
      *
-     * The caller should use the `rwlock` property to acquire a read/write lock
-     * before attempting to manipulate the buffer and release the lock when
-     * done. */
+     * The buffer is only guaranteed to stay unmodified in the thread
+     * performing sum-reads. Other readers should use read_data(). */
     uint8_t *get_buffer();
 
-    /* Pointer to underlaying buffer storage segment containing data, skipping
-     * over the results section.
-     *
-     * The caller should use the `rwlock` property to acquire a read/write lock
-     * before attempting to manipulate the buffer and release the lock when
-     * done. */
+    /* Pointer to underlaying published buffer storage segment containing data,
+     * skipping over the results section. The same rules as for get_buffer()
+     * apply. */
     uint8_t *get_buffer_data_section();
 
+    /* Pointer to the next buffer in the ring, into which code performing ADS
+     * sum read writes the response. The data becomes visible to readers with
+     * publish(). */
+    uint8_t *get_receive_buffer();
+
     /* Reserve storage in the buffer for a variable of DATA_SIZE bytes. On
      * success, OFFSET_RESULT points to ADS read operation result value for
      * the variable and OFFSET_DATA points to the read data.
@@ -92,8 +137,8 @@ class SumReadBuffer {
      * OFFSET_DATA and DATA_SIZE must match the values obtained/passed to the
      * previous call to add_variable().
      *
-     * This method implicitly acquires read lock before reading data from the
-     * underlying buffer. */
+     * The data is read without blocking the writer. The copy is retried if the
+     * writer could have reused the buffer while it was being read. */
     int read_data(uint16_t offset_result, size_t offset_data,
                   const size_t data_size, uint32_t *result, char *data);
 
@@ -101,15 +146,41 @@ class SumReadBuffer {
      * can be added to the buffer. */
     int initialize_buffer();
 
-    /* Saves a copy of the current buffer content into `prev_data_buffer`. The
-     * copy is used by get_updated_variables() to find variables whose values
-     * have changed after an ADS sum-read.
+    /* Lay out the buffer for reading the variables, which must be resolved.
+     * With MERGE_GAP >= 0, variables addressed by index group and offset
+     * (not by handle) are read in ranges: variables of the same index group
+     * whose data is at most MERGE_GAP bytes apart are read by a single
+     * sum-read entry, and decoded from their offset in the range. Otherwise,
+     * or with a negative MERGE_GAP, each variable is read by its own entry.
+     * The buffer is reallocated and its state set to invalid. */
+    int plan_ranges(const long merge_gap);
+
+    /* Ranges to read, one per entry of the ADS sum-read request */
+    const std::vector<ReadRange> &get_ranges();
+
+    /* Publish the data received into the receive buffer by swapping it with
+     * the published buffer and set the buffer state to valid. Variables whose
+     * result code or data differ from the previously published data are marked
+     * as updated. If the published
+     * buffer wasn't valid (e.g. after buffer initialization or a failed
+     * sum-read), all variables are marked as updated.
      *
-     * This method implicitly acquires write lock before copying the buffer. */
-    void save_buffer();
-
-    // for autoparam use
-    // std::vector<std::shared_ptr<Variable>> get_updated_variables(
-    //     std::vector<Autoparam::DeviceVariable *> &interruptVars);
+     * Must only be called by the thread that performed the ADS sum-read into
+     * the receive buffer. */
+    void publish();
+
+    /* Set the buffer state to invalid after a failed sum-read. If the buffer
+     * was valid, all variables are marked as updated, so that the failure is
+     * reported for each of them once; otherwise no variable is marked. */
+    void invalidate();
+
+    /* True if the variable at INDEX was marked as updated by the latest call
+     * to publish() or invalidate(). */
+    bool is_updated(uint32_t index);
+
+    /* Append variables marked as updated by the latest call to publish() to
+     * UPDATED. */
+    void get_updated_variables(
+        std::vector<std::shared_ptr<ADSVariable>> &updated);
 };
 #endif /* SUMREADBUFFER_H */
@@ -13,50 +13,33 @@
 #define ADSIGRP_SUMUP_READ 0xF080
 #endif
 
-/* Struct containing data needed to perform a single sum-read ADS operation */
-struct ReadRequestChunk {
-    /* ADS port (e.g. AMSPORT_R0_PLC_TC3) common to all variables in a chunk */
-    uint16_t ads_port;
-
-    /* Variables that are read in a sum-read operation */
-    std::vector<std::shared_ptr<ADSVariable>> variables;
-
-    /* Buffer containing data needed for a sum-read operation. For each variable
-     * in variables vector, it contains ADS index group, ADS index offset and
-     * data length. */
-    std::vector<AdsSymbolInfoByName> sum_read_request_buffer;
-
-    /* Sum read request buffer, containing the results of a sum-read operation
-     */
-    std::shared_ptr<SumReadBuffer> sum_read_data_buffer;
-
-    ReadRequestChunk(uint16_t ads_port, uint16_t max_variables)
-        : ads_port(ads_port), variables(), sum_read_request_buffer(),
-          sum_read_data_buffer(std::make_shared<SumReadBuffer>(max_variables)) {
+ReadRequestChunk::ReadRequestChunk(uint16_t ads_port, uint16_t max_variables)
+    : ads_port(ads_port), variables(), sum_read_request_buffer(),
+      sum_read_data_buffer(new SumReadBuffer(max_variables)) {}
+
+void ReadRequestChunk::add_variable(std::shared_ptr<ADSVariable> variable) {
+    int rc = this->sum_read_data_buffer->add_variable(variable);
+    if (rc != 0) {
+        throw std::length_error("could not add variable to sum-read buffer");
     }
 
-    void add_variable(std::shared_ptr<ADSVariable> variable) {
-        int rc = this->sum_read_data_buffer->add_variable(variable);
-        if (rc != 0) {
-            throw std::length_error(
-                "could not add variable to sum-read buffer");
-        }
+    this->sum_read_request_buffer.push_back({0, 0, 0});
 
-        this->sum_read_request_buffer.push_back({0, 0, 0});
+    this->variables.push_back(variable);
+}
 
-        this->variables.push_back(std::shared_ptr<ADSVariable>(variable));
-    }
-};
+int SumReadRequest::get_num_chunks() { return this->chunks.size(); }
 
-int SumReadRequest::get_num_chunks() { return this->get_chunks()->size(); }
+void SumReadRequest::set_merge_gap(const long gap) { this->merge_gap = gap; }
 
 bool SumReadRequest::is_allocated() { return this->allocated; }
 
 bool SumReadRequest::is_initialized() { return this->initialized; }
 
 SumReadRequest::SumReadRequest(const uint16_t max_variables_per_buffer,
-                               std::shared_ptr<Connection> connection)
-    : conn(connection) {
+                               std::shared_ptr<Connection> connection,
+                               const unsigned int parallelism)
+    : conn(connection), next_chunk(0), failed_chunks(0) {
     if (max_variables_per_buffer == 0) {
         throw std::invalid_argument(
             "max_variables_per_buffer must be larger than zero");
@@ -67,29 +50,31 @@ SumReadRequest::SumReadRequest(const uint16_t max_variables_per_buffer,
     if (connection == nullptr) {
         throw std::invalid_argument("connection must be set");
     }
-}
 
-SumReadRequest::~SumReadRequest() {
-    this->deinitialize();
-    this->deallocate();
+    if (parallelism == 0) {
+        throw std::invalid_argument("parallelism must be larger than zero");
+    }
+
+    this->parallelism = parallelism;
+    for (unsigned int lane = 1; lane < parallelism; lane++) {
+        this->workers.push_back(
+            std::thread(&SumReadRequest::worker, this, lane));
+    }
 }
 
-std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-SumReadRequest::get_chunks() {
-    auto v = std::make_shared<std::vector<std::shared_ptr<ReadRequestChunk>>>();
-
-    for (auto chunk_set_itr = this->chunks_by_ads_port.begin();
-         chunk_set_itr != this->chunks_by_ads_port.end(); chunk_set_itr++) {
-        std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-            chunk_set = chunk_set_itr->second;
-        for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-             chunk_itr++) {
-            std::shared_ptr<ReadRequestChunk> chunk = *chunk_itr;
-            v->push_back(std::shared_ptr<ReadRequestChunk>(chunk));
-        }
+SumReadRequest::~SumReadRequest() {
+    {
+        std::lock_guard<std::mutex> lock(this->workers_mtx);
+        this->workers_exit = true;
+    }
+    this->cycle_start_cv.notify_all();
+    for (auto worker_itr = this->workers.begin();
+         worker_itr != this->workers.end(); worker_itr++) {
+        worker_itr->join();
     }
 
-    return v;
+    this->deinitialize();
+    this->deallocate();
 }
 
 int SumReadRequest::allocate(
@@ -98,55 +83,65 @@ int SumReadRequest::allocate(
         return EPICSADS_INV_CALL;
     }
 
-    for (auto var_itr = variables.begin(); var_itr != variables.end();
-         var_itr++) {
-        /* Get variable and ADS port which it uses */
-        std::shared_ptr<ADSVariable> var = *var_itr;
-        uint32_t ads_port = var->addr->get_ads_port();
-
-        /* Create chunk set for the ADS port if necessary */
-        if (this->chunks_by_ads_port.find(ads_port) ==
-            this->chunks_by_ads_port.end()) {
-            this->chunks_by_ads_port[ads_port] = std::make_shared<
-                std::vector<std::shared_ptr<struct ReadRequestChunk>>>();
-        }
-
-        /* Get chunk set for ADS port */
-        std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-            chunk_set = this->chunks_by_ads_port[ads_port];
+    bool add_error = false;
+    {
+        /* Chunks are first grouped by ADS port and then flattened into the
+         * contiguous chunks vector. */
+        std::map<uint16_t, std::vector<ReadRequestChunk>> chunks_by_ads_port;
+        size_t num_chunks = 0;
+
+        for (auto var_itr = variables.begin(); var_itr != variables.end();
+             var_itr++) {
+            /* Get variable and ADS port which it uses */
+            std::shared_ptr<ADSVariable> var = *var_itr;
+            uint16_t ads_port = var->addr->get_ads_port();
+
+            /* Get chunk set for ADS port, create it if necessary */
+            std::vector<ReadRequestChunk> &chunk_set =
+                chunks_by_ads_port[ads_port];
+
+            /* Create read request chunk if it doesn't exist or if its read
+             * buffer is at full capacity  */
+            if (chunk_set.size() == 0 ||
+                chunk_set.back().sum_read_data_buffer->at_capacity() == true) {
+                chunk_set.emplace_back(ads_port, this->max_vars_per_buffer);
+                num_chunks++;
+            }
 
-        /* Create read request chunk if it doesn't exist or if its read buffer
-         * is at full capacity  */
-        if (chunk_set->size() == 0 ||
-            chunk_set->back()->sum_read_data_buffer->at_capacity() == true) {
-            chunk_set->push_back(std::make_shared<struct ReadRequestChunk>(
-                ads_port, this->max_vars_per_buffer));
+            /* Add variable to the last chunk, which should have capacity */
+            try {
+                chunk_set.back().add_variable(var);
+            } catch (const std::exception &ex) {
+                LOG_ERR("could not add ADS variable to read-request-chunk");
+                add_error = true;
+                break;
+            }
         }
 
-        /* Add variable to the last chunk, which should have capacity */
-        std::shared_ptr<ReadRequestChunk> chunk = chunk_set->back();
-        try {
-            chunk->add_variable(var);
-        } catch (const std::exception &ex) {
-            LOG_ERR("could not add ADS variable to read-request-chunk");
-            goto ALLOC_ERROR;
+        /* Chunks are flattened also on error, so that deallocate() decouples
+         * the variables that were already added. */
+        this->chunks.reserve(num_chunks);
+        for (auto chunk_set_itr = chunks_by_ads_port.begin();
+             chunk_set_itr != chunks_by_ads_port.end(); chunk_set_itr++) {
+            for (auto chunk_itr = chunk_set_itr->second.begin();
+                 chunk_itr != chunk_set_itr->second.end(); chunk_itr++) {
+                this->chunks.push_back(std::move(*chunk_itr));
+            }
         }
     }
 
+    if (add_error == true) {
+        goto ALLOC_ERROR;
+    }
+
     /* Initialize all sum-read data buffers */
-    for (auto chunk_set_itr = this->chunks_by_ads_port.begin();
-         chunk_set_itr != this->chunks_by_ads_port.end(); chunk_set_itr++) {
-        std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-            chunk_set = chunk_set_itr->second;
-        for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-             chunk_itr++) {
-            std::shared_ptr<ReadRequestChunk> chunk = *chunk_itr;
-            int rc = chunk->sum_read_data_buffer->initialize_buffer();
-            if (rc != 0) {
-                LOG_ERR("failed to initialize sum-read data buffer (%i): %s",
-                        rc, ads_errors[rc].c_str());
-                goto ALLOC_ERROR;
-            }
+    for (auto chunk_itr = this->chunks.begin(); chunk_itr != this->chunks.end();
+         chunk_itr++) {
+        int rc = chunk_itr->sum_read_data_buffer->initialize_buffer();
+        if (rc != 0) {
+            LOG_ERR("failed to initialize sum-read data buffer (%i): %s", rc,
+                    ads_errors[rc].c_str());
+            goto ALLOC_ERROR;
         }
     }
 
@@ -162,23 +157,15 @@ ALLOC_ERROR:
 int SumReadRequest::deallocate() {
     this->deinitialize();
 
-    for (auto chunk_set_itr = this->chunks_by_ads_port.begin();
-         chunk_set_itr != this->chunks_by_ads_port.end(); chunk_set_itr++) {
-        std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-            chunk_set = chunk_set_itr->second;
-        for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-             chunk_itr++) {
-            std::shared_ptr<ReadRequestChunk> chunk = *chunk_itr;
-            for (auto var_itr = chunk->variables.begin();
-                 var_itr != chunk->variables.end(); var_itr++) {
-                (*var_itr)->set_buffer_reader(EMPTY_BUFFER_DATA_POSITION);
-            }
+    for (auto chunk_itr = this->chunks.begin(); chunk_itr != this->chunks.end();
+         chunk_itr++) {
+        for (auto var_itr = chunk_itr->variables.begin();
+             var_itr != chunk_itr->variables.end(); var_itr++) {
+            (*var_itr)->set_buffer_reader(EMPTY_BUFFER_DATA_POSITION);
         }
-
-        chunk_set->clear();
     }
 
-    this->chunks_by_ads_port.clear();
+    this->chunks.clear();
 
     this->allocated = false;
 
@@ -197,24 +184,33 @@ int SumReadRequest::initialize() {
     }
 
     /* Configure sum-read request buffers with required data (ADS index group,
-     * ADS index offset and variable size). For index group/offset, the variable
-     * _must_ be resolved. */
-    auto chunk_set = this->get_chunks();
-    for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-         chunk_itr++) {
-        std::shared_ptr<ReadRequestChunk> chunk = *chunk_itr;
-
+     * ADS index offset and length of each range read). For index
+     * group/offset, the variable _must_ be resolved. */
+    for (auto chunk = this->chunks.begin(); chunk != this->chunks.end();
+         chunk++) {
         for (size_t i_var = 0; i_var < chunk->variables.size(); i_var++) {
-            std::shared_ptr<ADSVariable> var = chunk->variables[i_var];
+            const std::shared_ptr<ADSVariable> &var = chunk->variables[i_var];
             if (var->addr->is_resolved() == false) {
                 LOG_ERR("variable name is not resolved: '%s'",
                         var->addr->get_var_name().c_str());
                 return EPICSADS_NOT_RESOLVED;
             }
+        }
+
+        int rc = chunk->sum_read_data_buffer->plan_ranges(this->merge_gap);
+        if (rc != 0) {
+            LOG_ERR("could not plan sum-read ranges (%i): %s", rc,
+                    ads_errors[rc].c_str());
+            return rc;
+        }
 
-            chunk->sum_read_request_buffer[i_var] = {
-                var->addr->get_index_group(), var->addr->get_index_offset(),
-                var->size()};
+        const std::vector<SumReadBuffer::ReadRange> &ranges =
+            chunk->sum_read_data_buffer->get_ranges();
+        chunk->sum_read_request_buffer.resize(ranges.size());
+        for (size_t i_range = 0; i_range < ranges.size(); i_range++) {
+            chunk->sum_read_request_buffer[i_range] = {
+                ranges[i_range].index_group, ranges[i_range].index_offset,
+                ranges[i_range].length};
         }
     }
 
@@ -224,14 +220,15 @@ int SumReadRequest::initialize() {
 }
 
 int SumReadRequest::deinitialize() {
-    auto chunk_set = this->get_chunks();
-    for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-         chunk_itr++) {
-        std::shared_ptr<ReadRequestChunk> chunk = *chunk_itr;
+    for (auto chunk = this->chunks.begin(); chunk != this->chunks.end();
+         chunk++) {
         for (size_t i_var = 0; i_var < chunk->sum_read_request_buffer.size();
              i_var++) {
             chunk->sum_read_request_buffer[i_var] = {0, 0, 0};
         }
+        chunk->consecutive_failures = 0;
+        chunk->last_status = 0;
+        chunk->logged_status = 0;
     }
 
     this->initialized = false;
@@ -239,74 +236,197 @@ int SumReadRequest::deinitialize() {
     return 0;
 }
 
-void SumReadRequest::set_buffers_state(
-    SumReadBuffer::SumReadBufferState state) {
-    auto chunk_set = this->get_chunks();
-    for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
-         chunk_itr++) {
-        (*chunk_itr)->sum_read_data_buffer->buffer_state = state;
+int SumReadRequest::read_chunk(ReadRequestChunk &chunk, unsigned int lane) {
+    SumReadBuffer *sum_read_data_buffer = chunk.sum_read_data_buffer.get();
+
+    uint32_t nelem = chunk.sum_read_request_buffer.size();
+    uint32_t read_buffer_size = sum_read_data_buffer->get_size();
+    uint8_t *read_buffer = sum_read_data_buffer->get_receive_buffer();
+    uint32_t write_buffer_size =
+        chunk.sum_read_request_buffer.size() * sizeof(AdsSymbolInfoByName);
+    uint8_t *write_buffer = (uint8_t *)chunk.sum_read_request_buffer.data();
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+
+    if (sum_read_data_buffer->is_initialized() == false) {
+        return EPICSADS_NOT_INITIALIZED;
+    }
+
+    /* Only the connection's own ADS port is shared with other threads */
+    const long ads_port = this->conn->get_lane_ads_port(lane);
+    std::unique_lock<epicsMutex> lock(this->conn->mtx, std::defer_lock);
+    if (ads_port == this->conn->get_ads_port()) {
+        lock.lock();
+    }
+
+    AmsAddr remote_ams_addr = {this->conn->get_remote_ams_netid(),
+                               chunk.ads_port};
+
+    long rc = AdsSyncReadWriteReqEx2(
+        ads_port,           // ADS port
+        &remote_ams_addr,   // AMS address
+        ADSIGRP_SUMUP_READ, // index group
+        nelem, // offset; for SUMUP_READ it is the number of read commands
+        read_buffer_size, // read buffer size in bytes
+        read_buffer,      // read data buffer (written by PLC), where the read
+                          // operation results and data is stored
+        write_buffer_size, // write buffer size in bytes
+        write_buffer,  // write buffer (data sent to PLC), containing read
+                       // requests for PLC variables
+        &bytes_read);  // number of bytes read
+    if (rc != 0) {
+        return ads_rc_to_epicsads_error(rc);
+    }
+
+    sum_read_data_buffer->publish();
+
+    return 0;
+}
+
+void SumReadRequest::read_chunks(unsigned int lane) {
+    while (true) {
+        size_t i_chunk = this->next_chunk.fetch_add(1);
+        if (i_chunk >= this->chunks.size()) {
+            break;
+        }
+        ReadRequestChunk &chunk = this->chunks[i_chunk];
+
+        int rc = this->read_chunk(chunk, lane);
+        for (unsigned int retry = 0;
+             rc != 0 && rc != EPICSADS_NOT_INITIALIZED &&
+             retry < this->max_chunk_retries;
+             retry++) {
+            rc = this->read_chunk(chunk, lane);
+        }
+
+        /* Each chunk is only read by a single lane in a cycle */
+        chunk.last_status = rc;
+        if (rc != 0) {
+            chunk.consecutive_failures++;
+            chunk.sum_read_data_buffer->invalidate();
+            this->failed_chunks++;
+        } else {
+            chunk.consecutive_failures = 0;
+        }
     }
 }
 
+void SumReadRequest::worker(unsigned int lane) {
+    uint64_t last_cycle = 0;
+
+    std::unique_lock<std::mutex> lock(this->workers_mtx);
+    while (true) {
+        this->cycle_start_cv.wait(lock, [this, &last_cycle] {
+            return this->workers_exit == true || this->cycle != last_cycle;
+        });
+        if (this->workers_exit == true) {
+            break;
+        }
+        last_cycle = this->cycle;
+
+        lock.unlock();
+        this->read_chunks(lane);
+        lock.lock();
+
+        this->workers_busy--;
+        if (this->workers_busy == 0) {
+            this->cycle_done_cv.notify_one();
+        }
+    }
+}
 
 int SumReadRequest::read() {
     if (this->initialized == false) {
         return EPICSADS_INV_CALL;
     }
 
-    auto chunk_set = this->get_chunks();
-    for (auto chunk_itr = chunk_set->begin(); chunk_itr != chunk_set->end();
+    this->next_chunk.store(0);
+    this->failed_chunks.store(0);
+
+    /* Workers are only woken up if there is more than one chunk to read */
+    bool use_workers = (this->workers.size() > 0 && this->chunks.size() > 1);
+    if (use_workers == true) {
+        {
+            std::lock_guard<std::mutex> lock(this->workers_mtx);
+            this->cycle++;
+            this->workers_busy = this->workers.size();
+        }
+        this->cycle_start_cv.notify_all();
+    }
+
+    this->read_chunks(0);
+
+    if (use_workers == true) {
+        std::unique_lock<std::mutex> lock(this->workers_mtx);
+        this->cycle_done_cv.wait(
+            lock, [this] { return this->workers_busy == 0; });
+    }
+
+    /* Log chunks that start or stop failing, and return the status of the
+     * first failed chunk */
+    int status = 0;
+    for (auto chunk_itr = this->chunks.begin(); chunk_itr != this->chunks.end();
          chunk_itr++) {
-        std::shared_ptr<SumReadBuffer> sum_read_data_buffer =
-            (*chunk_itr)->sum_read_data_buffer;
-
-        sum_read_data_buffer->save_buffer();
-
-        uint32_t nelem = sum_read_data_buffer->get_num_variables();
-        uint32_t read_buffer_size = sum_read_data_buffer->get_size();
-        uint8_t *read_buffer = sum_read_data_buffer->get_buffer();
-        uint32_t write_buffer_size =
-            (*chunk_itr)->sum_read_request_buffer.size() *
-            sizeof(AdsSymbolInfoByName);
-        uint8_t *write_buffer =
-            (uint8_t *)(*chunk_itr)->sum_read_request_buffer.data();
-#ifdef USE_TC_ADS
-        ads_ui32 bytes_read = 0;
-#else
-        uint32_t bytes_read = 0;
-#endif
+        if (chunk_itr->last_status != chunk_itr->logged_status) {
+            if (chunk_itr->last_status != 0) {
+                LOG_WARN("sum-read of %zu variables on ADS port %u failed "
+                         "(%i): %s",
+                         chunk_itr->variables.size(), chunk_itr->ads_port,
+                         chunk_itr->last_status,
+                         ads_errors[chunk_itr->last_status].c_str());
+            } else {
+                LOG_WARN("sum-read of %zu variables on ADS port %u recovered",
+                         chunk_itr->variables.size(), chunk_itr->ads_port);
+            }
+            chunk_itr->logged_status = chunk_itr->last_status;
+        }
 
-        if (sum_read_data_buffer->is_initialized() == false) {
-            return EPICSADS_NOT_INITIALIZED;
+        if (status == 0) {
+            status = chunk_itr->last_status;
         }
+    }
 
-        std::lock_guard<epicsMutex> lock(this->conn->mtx);
-
-        AmsAddr remote_ams_addr = {this->conn->get_remote_ams_netid(),
-                                   (*chunk_itr)->ads_port};
-
-        long rc = AdsSyncReadWriteReqEx2(
-            this->conn->get_ads_port(), // ADS port
-            &remote_ams_addr,           // AMS address
-            ADSIGRP_SUMUP_READ,         // index group
-            nelem, // offset; for SUMUP_READ it is the number of read commands
-            read_buffer_size, // read buffer size in bytes
-            read_buffer, // read data buffer (written by PLC), where the read
-                         // operation results and data is stored
-            write_buffer_size, // write buffer size in bytes
-            write_buffer, // write buffer (data sent to PLC), containing read
-                          // requests for PLC variables
-            &bytes_read); // number of bytes read
-        if (rc != 0) {
-            this->set_buffers_state(SumReadBuffer::SumReadBufferState::Invalid);
-            return ads_rc_to_epicsads_error(rc);
+    if (this->failed_chunks.load() == 0) {
+        return 0;
+    }
+
+    if (this->failed_chunks.load() < this->chunks.size() &&
+        this->has_persistent_failure() == false) {
+        return 0;
+    }
+
+    return status;
+}
+
+bool SumReadRequest::has_persistent_failure() {
+    for (auto chunk_itr = this->chunks.begin(); chunk_itr != this->chunks.end();
+         chunk_itr++) {
+        if (chunk_itr->consecutive_failures >= this->max_chunk_failures) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<std::shared_ptr<ADSVariable>>
+SumReadRequest::get_updated_variables() {
+    std::vector<std::shared_ptr<ADSVariable>> updated;
+
+    for (auto chunk_itr = this->chunks.begin(); chunk_itr != this->chunks.end();
+         chunk_itr++) {
+        if (chunk_itr->sum_read_data_buffer->buffer_state !=
+            SumReadBuffer::SumReadBufferState::Valid) {
+            continue;
         }
 
-        sum_read_data_buffer->buffer_state =
-            SumReadBuffer::SumReadBufferState::Valid;
+        chunk_itr->sum_read_data_buffer->get_updated_variables(updated);
     }
 
-    return 0;
+    return updated;
 }
 
 void SumReadRequest::print_info(FILE *fd, int details) {
@@ -321,6 +441,7 @@ void SumReadRequest::print_info(FILE *fd, int details) {
                 "   - Number of sum-request and sum-read buffers (chunks) "
                 "allocated: %i\n",
                 this->get_num_chunks());
+        fprintf(fd, "   - Chunks read in parallel: %u\n", this->parallelism);
         fprintf(fd, "   - Buffers allocated: %s\n",
                 (this->is_allocated() == true ? "yes" : "no"));
         fprintf(fd, "   - Buffers initialized: %s\n",
@@ -329,32 +450,45 @@ void SumReadRequest::print_info(FILE *fd, int details) {
 
     if (details >= 2) {
         fprintf(fd, " Details:\n");
-        auto chunk_set = this->get_chunks();
-        for (size_t i_chunk = 0; i_chunk < chunk_set->size(); i_chunk++) {
-            auto chunk = chunk_set->at(i_chunk);
+        for (size_t i_chunk = 0; i_chunk < this->chunks.size(); i_chunk++) {
+            const ReadRequestChunk *chunk = &this->chunks[i_chunk];
             fprintf(fd, "  Buffers chunk #%zu/%i:\n", (i_chunk + 1),
                     this->get_num_chunks());
             fprintf(fd, "    - ADS port: %u\n", chunk->ads_port);
             fprintf(fd, "    - Number of variables: %zu\n",
                     chunk->variables.size());
+            fprintf(fd, "    - Number of sum-read entries: %zu\n",
+                    chunk->sum_read_request_buffer.size());
             fprintf(fd, "    - Sum-read buffer size: %zu bytes\n",
                     chunk->sum_read_data_buffer->get_size());
+            fprintf(fd, "    - Consecutive failed reads: %u\n",
+                    chunk->consecutive_failures);
 
             if (details >= 3) {
                 fprintf(fd, "    - Sum-request buffer elements:\n");
+                for (size_t i_entry = 0;
+                     i_entry < chunk->sum_read_request_buffer.size();
+                     i_entry++) {
+                    auto req_info = chunk->sum_read_request_buffer[i_entry];
+                    fprintf(fd, "    - Entry %zu/%zu:\n", (i_entry + 1),
+                            chunk->sum_read_request_buffer.size());
+                    fprintf(fd,
+                            "       - Port: %i; IGrp: %#09x; Ioff: %#09x; "
+                            "Length: %u\n",
+                            chunk->ads_port, req_info.indexGroup,
+                            req_info.indexOffset, req_info.cbLength);
+                }
                 for (size_t i_var = 0; i_var < chunk->variables.size();
                      i_var++) {
-                    auto var = chunk->variables[i_var];
-                    auto req_info = chunk->sum_read_request_buffer[i_var];
+                    const std::shared_ptr<ADSVariable> &var =
+                        chunk->variables[i_var];
+                    BufferDataPosition bdp = var->get_buffer_reader();
                     fprintf(fd, "    - Variable %zu/%zu:\n", (i_var + 1),
                             chunk->variables.size());
                     fprintf(fd, "       - Name: '%s'\n",
                             var->addr->info().c_str());
-                    fprintf(fd,
-                            "       - Port: %i; IGrp: %#09x; Ioff: %#09x; "
-                            "Length: %u\n",
-                            var->addr->get_ads_port(), req_info.indexGroup,
-                            req_info.indexOffset, req_info.cbLength);
+                    fprintf(fd, "       - Entry: %u; Data offset: %zu\n",
+                            bdp.off_result + 1, bdp.off_data);
                 }
             }
         }
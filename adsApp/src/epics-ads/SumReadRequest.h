@@ -10,6 +10,10 @@
 #include <memory>
 #include <cstdint>
 #include <utility>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #ifdef USE_TC_ADS
 #include <windows.h>
@@ -26,8 +30,38 @@
  * include). */
 class Connection;
 
-/* Used internally */
-struct ReadRequestChunk;
+/* Struct containing data needed to perform a single sum-read ADS operation.
+ * Used internally by SumReadRequest. */
+struct ReadRequestChunk {
+    /* ADS port (e.g. AMSPORT_R0_PLC_TC3) common to all variables in a chunk */
+    uint16_t ads_port;
+
+    /* Variables that are read in a sum-read operation */
+    std::vector<std::shared_ptr<ADSVariable>> variables;
+
+    /* Buffer containing data needed for a sum-read operation. For each variable
+     * in variables vector, it contains ADS index group, ADS index offset and
+     * data length. */
+    std::vector<AdsSymbolInfoByName> sum_read_request_buffer;
+
+    /* Sum read request buffer, containing the results of a sum-read operation.
+     * Variables keep a raw pointer to it (see BufferDataPosition), so the
+     * buffer must not move when the chunk itself is moved. */
+    std::unique_ptr<SumReadBuffer> sum_read_data_buffer;
+
+    /* Number of consecutive read() cycles in which the chunk couldn't be read
+     * and the status of the latest failure */
+    unsigned int consecutive_failures = 0;
+    int last_status = 0;
+
+    /* Status of the latest logged failure or recovery, so a chunk that keeps
+     * failing is only logged when its status changes */
+    int logged_status = 0;
+
+    ReadRequestChunk(uint16_t ads_port, uint16_t max_variables);
+
+    void add_variable(std::shared_ptr<ADSVariable> variable);
+};
 
 class SumReadRequest {
   protected:
@@ -36,18 +70,51 @@ class SumReadRequest {
     bool allocated = false;
     bool initialized = false;
 
-    void set_buffers_state(SumReadBuffer::SumReadBufferState state);
+    /* Number of chunks read concurrently. Each concurrent sum-read uses its
+     * own lane (ADS port) of the connection. */
+    unsigned int parallelism = 1;
+
+    /* Worker threads reading chunks on lanes 1 to parallelism - 1. Lane 0 is
+     * read by the thread calling read(). The workers are started by the
+     * constructor and wait for read() to start a cycle. */
+    std::vector<std::thread> workers;
+    std::mutex workers_mtx;
+    std::condition_variable cycle_start_cv; /* cycle started or exit */
+    std::condition_variable cycle_done_cv;  /* all workers are done */
+    uint64_t cycle = 0;           /* Incremented for each read() cycle */
+    unsigned int workers_busy = 0; /* Workers still reading in this cycle */
+    bool workers_exit = false;
+
+    /* Index of the next chunk to be read in the current cycle */
+    std::atomic<size_t> next_chunk;
+
+    /* Number of chunks that couldn't be read in the current cycle */
+    std::atomic<size_t> failed_chunks;
+
+    /* A chunk that fails is retried up to `max_chunk_retries` times in the
+     * same cycle. If it still fails, only its buffer is invalidated. read()
+     * fails once a chunk failed in `max_chunk_failures` consecutive cycles,
+     * or when all chunks fail in the same cycle. */
+    unsigned int max_chunk_retries = 1;
+    unsigned int max_chunk_failures = 5;
+
+    /* Largest gap in bytes between variables merged into a single sum-read
+     * entry, see SumReadBuffer::plan_ranges(). Negative disables merging. */
+    long merge_gap = -1;
+
+    /* Sum-read a single CHUNK using the ADS port of LANE */
+    int read_chunk(ReadRequestChunk &chunk, unsigned int lane);
+
+    /* Read chunks of the current cycle on LANE until none are left */
+    void read_chunks(unsigned int lane);
+
+    void worker(unsigned int lane);
 
     /* Read request chunks are grouped by ADS port (e.g. PLC_TC3), then split
      * according to max. number of variables per single sum-read buffer (e.g.
-     * 500). */
-    std::map< uint32_t,
-              std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>> >
-        chunks_by_ads_port;
-
-    /* Helper method returns a vector of chunks from chunks_by_ads_port_map */
-    std::shared_ptr<std::vector<std::shared_ptr<ReadRequestChunk>>>
-    get_chunks();
+     * 500). The chunks are stored contiguously and built once in allocate(),
+     * so that read() can walk them without any heap allocations. */
+    std::vector<ReadRequestChunk> chunks;
 
   public:
     /* Number of chunks, i.e. the number of sub-requests needed to sum-read all
@@ -57,8 +124,16 @@ class SumReadRequest {
     bool is_allocated();
     bool is_initialized();
 
+    /* Set the largest gap between variables read by a single sum-read entry.
+     * Takes effect with the next initialize(). */
+    void set_merge_gap(const long gap);
+
+    /* PARALLELISM sets the number of chunks read concurrently by read(). The
+     * connection must have been opened with at least as many lanes, otherwise
+     * the excess sum-reads share the connection's ADS port. */
     SumReadRequest(const uint16_t max_variables_per_buffer,
-                   std::shared_ptr<Connection> connection);
+                   std::shared_ptr<Connection> connection,
+                   const unsigned int parallelism = 1);
     ~SumReadRequest();
 
     /* Allocate space for ADS sum-read buffers used for performing ADS sum-read
@@ -80,11 +155,21 @@ class SumReadRequest {
     /* Deinitialize sum-read buffers. */
     int deinitialize();
 
-    /* Perform ADS sum-read operation. initialize() must be called before. */
+    /* Perform ADS sum-read operation. initialize() must be called before.
+     * Chunks are distributed over `parallelism` lanes and read() returns
+     * after all of them have been read. A chunk that can't be read only
+     * invalidates its own variables; read() returns an error if all chunks
+     * failed, or if a chunk keeps failing (see has_persistent_failure()). */
     int read();
 
-    /* Return ADS variables whose value has changed between two latest calls
-     * to read(). */
+    /* True if a chunk failed in `max_chunk_failures` consecutive read()
+     * cycles. Such a chunk is not expected to recover without resolving its
+     * variables again. */
+    bool has_persistent_failure();
+
+    /* Return ADS variables whose value or read result has changed between
+     * two latest calls to read(). All variables are returned after the first
+     * read() following initialization or a failed read(). */
     std::vector<std::shared_ptr<ADSVariable>> get_updated_variables();
 
     /* Print information about buffers used to FD. The DETAILS determines
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: 2022 Cosylab d.d.
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "SumWriteRequest.h"
+#include "Connection.h"
+#include "err.h"
+
+#ifndef ADSIGRP_SUMUP_WRITE
+#define ADSIGRP_SUMUP_WRITE 0xF081
+#endif
+
+SumWriteRequest::SumWriteRequest(const uint16_t max_variables_per_request,
+                                 std::shared_ptr<Connection> connection)
+    : conn(connection) {
+    if (max_variables_per_request == 0) {
+        throw std::invalid_argument(
+            "max_variables_per_request must be larger than zero");
+    }
+
+    this->max_vars_per_request = max_variables_per_request;
+
+    if (connection == nullptr) {
+        throw std::invalid_argument("connection must be set");
+    }
+}
+
+int SumWriteRequest::queue(std::shared_ptr<ADSVariable> variable,
+                           const char *data, const uint32_t size) {
+    if (variable == nullptr || data == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    if (this->conn->is_connected() == false) {
+        return EPICSADS_DISCONNECTED;
+    }
+
+    if (variable->addr->is_resolved() == false) {
+        return EPICSADS_NOT_RESOLVED;
+    }
+
+    if (size > variable->size()) {
+        return EPICSADS_OVERFLOW;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mtx);
+
+    try {
+        auto index_itr = this->pending_index.find(variable.get());
+        if (index_itr == this->pending_index.end()) {
+            this->pending.push_back({variable, {}});
+            this->pending_index[variable.get()] = this->pending.size() - 1;
+            index_itr = this->pending_index.find(variable.get());
+        }
+
+        std::vector<uint8_t> &slot = this->pending[index_itr->second].data;
+        slot.assign(variable->size(), 0);
+        memcpy(slot.data(), data, size);
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not queue write: %s", ex.what());
+        return EPICSADS_ERROR;
+    }
+
+    return 0;
+}
+
+size_t SumWriteRequest::get_num_pending() {
+    std::lock_guard<std::mutex> lock(this->mtx);
+
+    return this->pending.size();
+}
+
+void SumWriteRequest::flush(std::vector<SumWriteResult> &completed) {
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->flushing.swap(this->pending);
+        this->pending_index.clear();
+    }
+
+    if (this->flushing.size() == 0) {
+        return;
+    }
+
+    /* Variables could have been unresolved since their writes were queued */
+    auto unresolved_itr = std::stable_partition(
+        this->flushing.begin(), this->flushing.end(),
+        [](const PendingWrite &write) {
+            return write.variable->addr->is_resolved();
+        });
+    for (auto write_itr = unresolved_itr; write_itr != this->flushing.end();
+         write_itr++) {
+        completed.push_back({write_itr->variable, EPICSADS_NOT_RESOLVED});
+    }
+    this->flushing.erase(unresolved_itr, this->flushing.end());
+
+    /* Sum requests are sent to a single ADS port, so writes are grouped by
+     * ADS port first */
+    std::stable_sort(this->flushing.begin(), this->flushing.end(),
+                     [](const PendingWrite &a, const PendingWrite &b) {
+                         return a.variable->addr->get_ads_port() <
+                                b.variable->addr->get_ads_port();
+                     });
+
+    size_t first = 0;
+    while (first < this->flushing.size()) {
+        uint16_t ads_port = this->flushing[first].variable->addr->get_ads_port();
+
+        size_t last = first;
+        while (last < this->flushing.size() &&
+               last - first < this->max_vars_per_request &&
+               this->flushing[last].variable->addr->get_ads_port() ==
+                   ads_port) {
+            last++;
+        }
+
+        this->write_chunk(ads_port, first, last, completed);
+        first = last;
+    }
+
+    this->flushing.clear();
+}
+
+void SumWriteRequest::discard(int status,
+                              std::vector<SumWriteResult> &completed) {
+    std::lock_guard<std::mutex> lock(this->mtx);
+
+    for (auto write_itr = this->pending.begin();
+         write_itr != this->pending.end(); write_itr++) {
+        completed.push_back({write_itr->variable, status});
+    }
+
+    this->pending.clear();
+    this->pending_index.clear();
+}
+
+void SumWriteRequest::write_chunk(const uint16_t ads_port, size_t first,
+                                  size_t last,
+                                  std::vector<SumWriteResult> &completed) {
+    const size_t nvars = last - first;
+    const size_t requests_size = nvars * sizeof(AdsSymbolInfoByName);
+
+    /* Write buffer: request entries, followed by the data of all writes */
+    size_t data_size = 0;
+    for (size_t i = first; i < last; i++) {
+        data_size += this->flushing[i].data.size();
+    }
+
+    try {
+        this->write_buffer.resize(requests_size + data_size);
+        this->results.assign(nvars, 0);
+    } catch (const std::exception &ex) {
+        LOG_ERR("could not allocate sum-write buffers: %s", ex.what());
+        for (size_t i = first; i < last; i++) {
+            completed.push_back({this->flushing[i].variable, EPICSADS_ERROR});
+        }
+        return;
+    }
+
+    AdsSymbolInfoByName *requests =
+        (AdsSymbolInfoByName *)this->write_buffer.data();
+    uint8_t *data = this->write_buffer.data() + requests_size;
+    for (size_t i = first; i < last; i++) {
+        const PendingWrite &write = this->flushing[i];
+        requests[i - first] = {write.variable->addr->get_index_group(),
+                               write.variable->addr->get_index_offset(),
+                               (uint32_t)write.data.size()};
+        memcpy(data, write.data.data(), write.data.size());
+        data += write.data.size();
+    }
+
+#ifdef USE_TC_ADS
+    ads_ui32 bytes_read = 0;
+#else
+    uint32_t bytes_read = 0;
+#endif
+
+    std::lock_guard<epicsMutex> lock(this->conn->mtx);
+
+    AmsAddr remote_ams_addr = {this->conn->get_remote_ams_netid(), ads_port};
+
+    long rc = AdsSyncReadWriteReqEx2(
+        this->conn->get_ads_port(), // ADS port
+        &remote_ams_addr,           // AMS address
+        ADSIGRP_SUMUP_WRITE,        // index group
+        nvars, // offset; for SUMUP_WRITE it is the number of write commands
+        this->results.size() * sizeof(uint32_t), // read buffer size in bytes
+        this->results.data(),       // result code of each write
+        this->write_buffer.size(),  // write buffer size in bytes
+        this->write_buffer.data(),  // write requests and data
+        &bytes_read);               // number of bytes read
+
+    if (rc == ADSERR_DEVICE_SRVNOTSUPP) {
+        /* ADS device doesn't support sum commands, write variables one by
+         * one instead */
+        for (size_t i = first; i < last; i++) {
+            const PendingWrite &write = this->flushing[i];
+            this->results[i - first] = AdsSyncWriteReqEx(
+                this->conn->get_ads_port(), &remote_ams_addr,
+                write.variable->addr->get_index_group(),
+                write.variable->addr->get_index_offset(), write.data.size(),
+                const_cast<uint8_t *>(write.data.data()));
+        }
+    } else if (rc != 0) {
+        int status = ads_rc_to_epicsads_error(rc);
+        for (size_t i = first; i < last; i++) {
+            completed.push_back({this->flushing[i].variable, status});
+        }
+        return;
+    } else if (bytes_read < this->results.size() * sizeof(uint32_t)) {
+        LOG_ERR("sum-write response too short (%zu bytes)",
+                (size_t)bytes_read);
+        for (size_t i = first; i < last; i++) {
+            completed.push_back({this->flushing[i].variable, EPICSADS_ERROR});
+        }
+        return;
+    }
+
+    for (size_t i = first; i < last; i++) {
+        PendingWrite &write = this->flushing[i];
+        uint32_t result = this->results[i - first];
+
+        if (result != 0) {
+            completed.push_back(
+                {write.variable, ads_rc_to_epicsads_error(result)});
+            continue;
+        }
+
+        completed.push_back({write.variable, 0, std::move(write.data)});
+    }
+}
@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: 2022 Cosylab d.d.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef SUMWRITEREQUEST_H
+#define SUMWRITEREQUEST_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+
+#ifdef USE_TC_ADS
+#include <windows.h>
+#include <TcAdsDef.h>
+#include <TcAdsApi.h>
+#else
+#include <AdsLib.h>
+#endif
+
+#include "Variable.h"
+
+/* Defined in Connection.h, which includes this header file (prevent cyclic
+ * include). */
+class Connection;
+
+/* Outcome of a queued write, returned by SumWriteRequest::flush() */
+struct SumWriteResult {
+    std::shared_ptr<ADSVariable> variable;
+    int status; /* 0 or EPICSADS_* error code */
+
+    /* Data written if successful. The caller passes it to
+     * ADSVariable::set_written() under the lock serializing reads of the
+     * variable. */
+    std::vector<uint8_t> data;
+};
+
+/* Queue of writes to ADS variables, which are sent to the ADS device in ADS
+ * sum-write requests. Each variable has a single slot in the queue: a write
+ * to a variable which already has a pending write replaces the pending value.
+ */
+class SumWriteRequest {
+  protected:
+    /* Value waiting to be written to an ADS variable */
+    struct PendingWrite {
+        std::shared_ptr<ADSVariable> variable;
+        std::vector<uint8_t> data;
+    };
+
+    std::shared_ptr<Connection> conn;
+    uint16_t max_vars_per_request = 0;
+
+    /* Protects `pending` and `pending_index` */
+    std::mutex mtx;
+
+    /* Pending writes, in the order the variables were first queued */
+    std::vector<PendingWrite> pending;
+
+    /* Index of the pending write slot for each variable */
+    std::unordered_map<ADSVariable *, size_t> pending_index;
+
+    /* Writes being flushed. Swapped with `pending`, so that queue() isn't
+     * blocked while the sum-write requests are sent. */
+    std::vector<PendingWrite> flushing;
+
+    /* Buffers used for building a single ADS sum-write request */
+    std::vector<uint8_t> write_buffer;
+    std::vector<uint32_t> results;
+
+    /* Send writes FLUSHING[FIRST, LAST), which all use ADS_PORT, in a single
+     * ADS sum-write request and append their outcome to COMPLETED. */
+    void write_chunk(const uint16_t ads_port, size_t first, size_t last,
+                     std::vector<SumWriteResult> &completed);
+
+  public:
+    SumWriteRequest(const uint16_t max_variables_per_request,
+                    std::shared_ptr<Connection> connection);
+
+    /* Queue writing DATA of SIZE bytes to VARIABLE. The value is zero-padded
+     * to the variable size. If VARIABLE already has a pending write, its
+     * value is replaced. */
+    int queue(std::shared_ptr<ADSVariable> variable, const char *data,
+              const uint32_t size);
+
+    /* Number of variables with a pending write */
+    size_t get_num_pending();
+
+    /* Send all pending writes to the ADS device, grouped by ADS port into
+     * sum-write requests of up to `max_variables_per_request` variables.
+     * The outcome of each write is appended to COMPLETED. */
+    void flush(std::vector<SumWriteResult> &completed);
+
+    /* Drop all pending writes, reporting them in COMPLETED with STATUS */
+    void discard(int status, std::vector<SumWriteResult> &completed);
+};
+
+#endif /* SUMWRITEREQUEST_H */
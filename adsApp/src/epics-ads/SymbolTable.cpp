@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2022 Cosylab d.d.
+//
+// SPDX-License-Identifier: MIT
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "SymbolTable.h"
+#include "err.h"
+
+#ifndef ADST_BIGTYPE
+#define ADST_BIGTYPE 65
+#endif
+
+/* Size of the fixed part of an entry in the ADSIGRP_SYM_UPLOAD response
+ * (AdsSymbolEntry): entry length, index group, index offset, size, data type
+ * and flags (4 bytes each), followed by name, type and comment lengths (2
+ * bytes each). The zero terminated name, type and comment follow. */
+static const size_t symbol_entry_header_size = 30;
+
+static std::string to_lower(const std::string &name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return lower;
+}
+
+static uint32_t get_uint32(const uint8_t *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint16_t get_uint16(const uint8_t *data) {
+    uint16_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+int SymbolTable::parse(const std::vector<uint8_t> &data) {
+    std::unordered_map<std::string, Symbol> parsed;
+
+    size_t pos = 0;
+    while (pos + symbol_entry_header_size <= data.size()) {
+        const uint8_t *entry = data.data() + pos;
+        uint32_t entry_length = get_uint32(entry);
+        uint16_t name_length = get_uint16(entry + 24);
+
+        if (entry_length < symbol_entry_header_size ||
+            pos + entry_length > data.size() ||
+            symbol_entry_header_size + name_length > entry_length) {
+            LOG_ERR("malformed symbol table entry at byte %zu", pos);
+            return EPICSADS_ERROR;
+        }
+
+        Symbol symbol = {get_uint32(entry + 4), get_uint32(entry + 8),
+                         get_uint32(entry + 12), get_uint32(entry + 16)};
+        std::string name(
+            reinterpret_cast<const char *>(entry + symbol_entry_header_size),
+            name_length);
+        parsed[to_lower(name)] = symbol;
+
+        pos += entry_length;
+    }
+
+    this->symbols.swap(parsed);
+
+    return 0;
+}
+
+int SymbolTable::read_cache(const std::string &path) {
+    std::ifstream file(path.c_str());
+    if (!file) {
+        return EPICSADS_NO_DATA;
+    }
+
+    std::string key;
+    if (!std::getline(file, key) || key != this->key) {
+        return EPICSADS_NO_DATA;
+    }
+
+    std::unordered_map<std::string, Symbol> cached;
+    std::string name;
+    Symbol symbol;
+    while (file >> name >> symbol.index_group >> symbol.index_offset >>
+           symbol.size >> symbol.data_type) {
+        cached[name] = symbol;
+    }
+
+    if (!file.eof()) {
+        LOG_WARN("malformed symbol table cache '%s'", path.c_str());
+        return EPICSADS_ERROR;
+    }
+
+    this->symbols.swap(cached);
+
+    return 0;
+}
+
+int SymbolTable::write_cache(const std::string &path) {
+    /* Written to a temporary file first, so that an interrupted write doesn't
+     * leave a truncated cache behind */
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file(tmp_path.c_str(), std::ios::trunc);
+        if (!file) {
+            return EPICSADS_ERROR;
+        }
+
+        file << this->key << "\n";
+        for (auto symbol_itr = this->symbols.begin();
+             symbol_itr != this->symbols.end(); symbol_itr++) {
+            const Symbol &symbol = symbol_itr->second;
+            file << symbol_itr->first << " " << symbol.index_group << " "
+                 << symbol.index_offset << " " << symbol.size << " "
+                 << symbol.data_type << "\n";
+        }
+
+        if (!file) {
+            return EPICSADS_ERROR;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        return EPICSADS_ERROR;
+    }
+
+    return 0;
+}
+
+int SymbolTable::load(std::shared_ptr<Connection> conn,
+                      const uint16_t ads_port, const std::string &cache_dir,
+                      const bool read_cached) {
+    if (conn == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    this->cached = false;
+
+    uint8_t version = 0;
+    int status = conn->read_symbol_version(ads_port, &version);
+    if (status != 0) {
+        return status;
+    }
+
+    SymbolUploadInfo info;
+    status = conn->read_symbol_upload_info(ads_port, &info);
+    if (status != 0) {
+        return status;
+    }
+
+    std::ostringstream key;
+    key << "adsDriver symbol table 1 " << (unsigned)version << " "
+        << info.num_symbols << " " << info.symbols_size << " "
+        << info.num_datatypes << " " << info.datatypes_size;
+    this->key = key.str();
+
+    std::string path;
+    if (cache_dir.empty() == false) {
+        const AmsNetId netid = conn->get_remote_ams_netid();
+        std::ostringstream path_stream;
+        path_stream << cache_dir << "/";
+        for (int i = 0; i < 6; i++) {
+            path_stream << (unsigned)netid.b[i] << (i < 5 ? "." : "_");
+        }
+        path_stream << ads_port << ".sym";
+        path = path_stream.str();
+
+        if (read_cached == true && this->read_cache(path) == 0) {
+            LOG_TRACE("read %zu symbols from cache '%s'", this->symbols.size(),
+                      path.c_str());
+            this->cached = true;
+            return 0;
+        }
+    }
+
+    std::vector<uint8_t> data;
+    status = conn->upload_symbols(ads_port, data);
+    if (status != 0) {
+        return status;
+    }
+
+    status = this->parse(data);
+    if (status != 0) {
+        return status;
+    }
+
+    if (path.empty() == false && this->write_cache(path) != 0) {
+        LOG_WARN("could not write symbol table cache '%s'", path.c_str());
+    }
+
+    return 0;
+}
+
+const SymbolTable::Symbol *SymbolTable::find(const std::string &name) const {
+    auto symbol_itr = this->symbols.find(to_lower(name));
+    if (symbol_itr == this->symbols.end()) {
+        return nullptr;
+    }
+
+    return &symbol_itr->second;
+}
+
+size_t SymbolTable::size() const { return this->symbols.size(); }
+
+bool SymbolTable::is_cached() const { return this->cached; }
+
+int SymbolTable::verify(
+    std::shared_ptr<Connection> conn, const uint16_t ads_port,
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) const {
+    if (conn == nullptr) {
+        return EPICSADS_INV_PARAM;
+    }
+
+    std::vector<std::string> names;
+    std::vector<const Symbol *> symbols;
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        if ((*var_itr)->addr->is_resolved() == true) {
+            continue;
+        }
+
+        const Symbol *symbol = this->find((*var_itr)->addr->get_var_name());
+        if (symbol != nullptr) {
+            names.push_back((*var_itr)->addr->get_var_name());
+            symbols.push_back(symbol);
+        }
+    }
+
+    std::vector<SymbolInfo> infos;
+    std::vector<int> statuses;
+    conn->read_symbol_infos(ads_port, names, infos, statuses);
+
+    for (size_t i = 0; i < names.size(); i++) {
+        if (statuses[i] != 0) {
+            return statuses[i];
+        }
+
+        if (infos[i].index_group != symbols[i]->index_group ||
+            infos[i].index_offset != symbols[i]->index_offset ||
+            infos[i].size != symbols[i]->size) {
+            LOG_TRACE("symbol '%s' moved to 0x%x:0x%x (%u bytes)",
+                      names[i].c_str(), infos[i].index_group,
+                      infos[i].index_offset, infos[i].size);
+            return EPICSADS_OUT_OF_RANGE;
+        }
+    }
+
+    return 0;
+}
+
+size_t SymbolTable::resolve_variables(
+    const std::vector<std::shared_ptr<ADSVariable>> &ads_variables) {
+    size_t resolved = 0;
+
+    for (auto var_itr = ads_variables.begin(); var_itr != ads_variables.end();
+         var_itr++) {
+        std::shared_ptr<ADSVariable> ads_var = *var_itr;
+        if (ads_var->addr->is_resolved() == true) {
+            continue;
+        }
+
+        const Symbol *symbol = this->find(ads_var->addr->get_var_name());
+        if (symbol == nullptr) {
+            continue;
+        }
+
+        if (ads_var->size() > symbol->size) {
+            LOG_ERR("ADS variable '%s' (%u bytes) is larger than its symbol "
+                    "(%u bytes)",
+                    ads_var->addr->info().c_str(), ads_var->size(),
+                    symbol->size);
+            continue;
+        }
+
+        auto id_itr = ads_datatype_ids.find(ads_var->addr->get_data_type());
+        if (id_itr != ads_datatype_ids.end() &&
+            symbol->data_type != id_itr->second &&
+            symbol->data_type != ADST_BIGTYPE) {
+            LOG_WARN("data type of ADS variable '%s' doesn't match its symbol "
+                     "(ADS data type ID %u)",
+                     ads_var->addr->info().c_str(), symbol->data_type);
+        }
+
+        if (ads_var->addr->resolve(symbol->index_group,
+                                   symbol->index_offset) == 0) {
+            resolved++;
+        }
+    }
+
+    return resolved;
+}
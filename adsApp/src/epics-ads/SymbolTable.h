@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2022 Cosylab d.d.
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+
+#include "Connection.h"
+#include "Variable.h"
+
+/* Symbol table of an ADS device (e.g. a PLC runtime), used for resolving
+ * variable names to index group/offset without requesting a handle for each
+ * variable. Only top-level symbols (e.g. MAIN.counter) are listed; variables
+ * not found in the table must be resolved with handles. */
+class SymbolTable {
+  public:
+    /* Symbol table entry */
+    struct Symbol {
+        uint32_t index_group;
+        uint32_t index_offset;
+        uint32_t size;      /* Size in bytes */
+        uint32_t data_type; /* ADS data type ID, e.g. ADST_INT16 */
+    };
+
+  protected:
+    /* Symbols by lowercase name, since ADS symbol names are case
+     * insensitive */
+    std::unordered_map<std::string, Symbol> symbols;
+
+    /* Identifies the symbol table contents: symbol version and sizes of the
+     * table. A cached table is only used if its key matches. */
+    std::string key;
+
+    /* True if the table was read from the cache */
+    bool cached = false;
+
+    /* Parse the response of an ADSIGRP_SYM_UPLOAD request */
+    int parse(const std::vector<uint8_t> &data);
+
+    int read_cache(const std::string &path);
+    int write_cache(const std::string &path);
+
+  public:
+    /* Load the symbol table of the ADS device at ADS_PORT. If CACHE_DIR is
+     * not empty, the table is read from a file in CACHE_DIR when the symbol
+     * version and table size of the device are unchanged and READ_CACHED is
+     * true, otherwise it is uploaded and the file is updated. */
+    int load(std::shared_ptr<Connection> conn, const uint16_t ads_port,
+             const std::string &cache_dir, const bool read_cached = true);
+
+    /* True if the table was read from the cache by load() */
+    bool is_cached() const;
+
+    /* Check the symbols of unresolved ADS_VARIABLES found in the table
+     * against the ADS device at ADS_PORT, whose symbol infos are read with
+     * ADS sum requests. The cache key can't tell an online change that moves
+     * symbols without changing the table size, so a cached table must be
+     * verified before it is used. Returns 0 if the index group, index offset
+     * and size of each symbol match, otherwise an EPICSADS_* error code. */
+    int verify(std::shared_ptr<Connection> conn, const uint16_t ads_port,
+               const std::vector<std::shared_ptr<ADSVariable>> &ads_variables)
+        const;
+
+    /* Symbol named NAME, or nullptr if there is none */
+    const Symbol *find(const std::string &name) const;
+
+    /* Number of symbols in the table */
+    size_t size() const;
+
+    /* Resolve unresolved ADS_VARIABLES that are found in the table. The
+     * declared size must fit into the symbol, and a data type mismatch is
+     * reported. Returns the number of resolved variables. */
+    size_t resolve_variables(
+        const std::vector<std::shared_ptr<ADSVariable>> &ads_variables);
+};
+
+#endif /* SYMBOLTABLE_H */
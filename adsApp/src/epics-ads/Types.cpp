@@ -33,6 +33,13 @@ std::map<std::string, ADSDataType> ads_datatypes = {
     {"REAL", ADSDataType::REAL},   {"LREAL", ADSDataType::LREAL},
     {"LINT", ADSDataType::LINT},   {"STRING", ADSDataType::STRING}};
 
+std::map<ADSDataType, uint32_t> ads_datatype_ids = {
+    {ADSDataType::BOOL, 33},  {ADSDataType::SINT, 16},  {ADSDataType::BYTE, 17},
+    {ADSDataType::USINT, 17}, {ADSDataType::INT, 2},    {ADSDataType::WORD, 18},
+    {ADSDataType::DWORD, 19}, {ADSDataType::UINT, 18},  {ADSDataType::DINT, 3},
+    {ADSDataType::UDINT, 19}, {ADSDataType::REAL, 4},   {ADSDataType::LREAL, 5},
+    {ADSDataType::LINT, 20},  {ADSDataType::STRING, 30}};
+
 /* Map to constants defines in AdsDef.h */
 std::map<std::string, uint16_t> ads_port_map = {
     {"LOGGER", AMSPORT_LOGGER},        {"RTIME", AMSPORT_R0_RTIME},
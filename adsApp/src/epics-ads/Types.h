@@ -62,6 +62,10 @@ extern std::map<ADSDataType, size_t> ads_datatype_sizes;
 extern std::map<std::string, ADSDataType> ads_datatypes;
 extern std::map<ADSDataType, std::string> ads_datatypes_str;
 
+/* Map to ADS data type IDs (ADSDATATYPEID in TcAdsDef.h), as listed in the
+ * symbol table of an ADS device */
+extern std::map<ADSDataType, uint32_t> ads_datatype_ids;
+
 /* Map port names (e.g. "PLC_TC3" to constants (e.g. AMSPORT_R0_PLC_TC3)
  * defined in AdsDef.h */
 extern std::map<std::string, uint16_t> ads_port_map;
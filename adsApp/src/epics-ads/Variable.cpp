@@ -28,23 +28,141 @@ BufferDataPosition ADSVariable::get_buffer_reader() {
     return this->buffer_reader;
 }
 
+bool ADSVariable::is_updated() {
+    if (this->readback_pending()) {
+        return true;
+    }
+
+    if (this->read_source == nullptr && this->uses_notification()) {
+        return this->value_updated.exchange(false);
+    }
+
+    return this->is_read_updated();
+}
+
+bool ADSVariable::is_read_updated() {
+    if (this->read_source != nullptr) {
+        return this->read_source->is_read_updated();
+    }
+
+    if (this->buffer_reader.buffer == nullptr) {
+        return false;
+    }
+
+    return this->buffer_reader.buffer->is_updated(
+        this->buffer_reader.index);
+}
+
+bool ADSVariable::readback_pending() {
+    return this->write_readback && !this->last_written.empty();
+}
+
+bool ADSVariable::uses_notification() {
+    return this->addr->get_operation() == Operation::Read &&
+           this->addr->get_notification_delay() > 0;
+}
+
+void ADSVariable::set_notification(const uint32_t handle,
+                                   const uint32_t user) {
+    this->notification_handle = handle;
+    this->notification_user = user;
+}
+
+uint32_t ADSVariable::get_notification_handle() {
+    return this->notification_handle;
+}
+
+uint32_t ADSVariable::get_notification_user() {
+    return this->notification_user;
+}
+
+void ADSVariable::store_notification_value(const uint8_t *data,
+                                           const uint32_t size) {
+    {
+        std::lock_guard<std::mutex> lock(this->value_mtx);
+
+        /* Notifications carry the whole variable, anything else is ignored */
+        if (size != this->value.size()) {
+            LOG_WARN("variable '%s' notification size mismatch (%u != %zu)",
+                     this->addr->info().c_str(), size, this->value.size());
+            return;
+        }
+
+        memcpy(this->value.data(), data, size);
+        this->value_valid = true;
+    }
+
+    this->value_updated = true;
+}
+
+void ADSVariable::invalidate_value() {
+    std::lock_guard<std::mutex> lock(this->value_mtx);
+
+    this->value_valid = false;
+}
+
 bool ADSVariable::uses_write_readback() { return this->write_readback; }
 
 void ADSVariable::set_write_readback(const bool readback) {
     this->write_readback = readback;
 }
 
-bool ADSVariable::updateDataHash(int new_hash) {
-    bool changed = new_hash != array_data_hash;
-    array_data_hash = new_hash;
-    return changed;
+void ADSVariable::set_read_source(std::shared_ptr<ADSVariable> source,
+                                  const uint32_t offset) {
+    this->read_source = source;
+    this->read_source_offset = offset;
 }
 
-ADSVariable::ADSVariable(std::shared_ptr<ADSAddress> address) : addr(address) {
+ADSVariable::ADSVariable(std::shared_ptr<ADSAddress> address)
+    : value_updated(false), addr(address) {
     this->elem_size = ads_datatype_sizes.at(this->addr->get_data_type());
+
+    if (this->uses_notification()) {
+        this->value.assign(this->size(), 0);
+    }
 }
 
 int ADSVariable::read_from_buffer(const uint32_t size, char *buffer) {
+    /* Number of bytes to read is set to whichever is smaller (bytewise). If it
+     * is the PLC variable, the driver shouldn't read past it. If data buffer is
+     * smaller, the driver shouldn't write past it. */
+    int rc = this->read_data(0, std::min(size, this->size()), buffer);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* Return the written value for the first read after a write to avoid
+     * jumping between "new value" -> "old value" -> "new value" */
+    if (write_readback && !last_written.empty()) {
+        memcpy(buffer, last_written.data(), last_written.size());
+        last_written.clear();
+    }
+
+    return 0;
+}
+
+int ADSVariable::read_data(const uint32_t offset, const uint32_t size,
+                           char *buffer) {
+    if (this->read_source != nullptr) {
+        return this->read_source->read_data(this->read_source_offset + offset,
+                                            size, buffer);
+    }
+
+    if (offset > this->size() || size > this->size() - offset) {
+        return EPICSADS_OVERFLOW;
+    }
+
+    if (this->uses_notification()) {
+        std::lock_guard<std::mutex> lock(this->value_mtx);
+
+        if (this->value_valid == false) {
+            return EPICSADS_DISCONNECTED;
+        }
+
+        memcpy(buffer, this->value.data() + offset, size);
+        return 0;
+    }
+
     if (this->buffer_reader == EMPTY_BUFFER_DATA_POSITION) {
         return EPICSADS_NO_DATA;
     }
@@ -59,15 +177,11 @@ int ADSVariable::read_from_buffer(const uint32_t size, char *buffer) {
         return EPICSADS_DISCONNECTED;
     }
 
-    /* Number of bytes to read is set to whichever is smaller (bytewise). If it
-     * is the PLC variable, the driver shouldn't read past it. If data buffer is
-     * smaller, the driver shouldn't write past it. */
-    uint32_t bytes_to_read = std::min(size, this->size());
     uint32_t read_result = 0;
 
     /* Read latest data and read result from buffer */
     int rc = buffer_reader.buffer->read_data(
-        buffer_reader.off_result, buffer_reader.off_data, bytes_to_read,
+        buffer_reader.off_result, buffer_reader.off_data + offset, size,
         &read_result, buffer);
 
     /* Return error if sum-read operation wasn't successul */
@@ -84,40 +198,9 @@ int ADSVariable::read_from_buffer(const uint32_t size, char *buffer) {
         return EPICSADS_NO_DATA;
     }
 
-    /* Return the written value for the first read after a write to avoid
-     * jumping between "new value" -> "old value" -> "new value" */
-    if (write_readback && !last_written.empty()) {
-        memcpy(buffer, last_written.data(), last_written.size());
-        last_written.clear();
-    }
-
     return 0;
 }
 
-std::pair<uint8_t *, RWLock *> ADSVariable::get_read_data() {
-    if (this->buffer_reader == EMPTY_BUFFER_DATA_POSITION) {
-        return {nullptr, nullptr};
-    }
-
-    if (this->buffer_reader.buffer == nullptr) {
-        // TODO: shouldn't happen
-        return {nullptr, nullptr};
-    }
-
-    if (this->buffer_reader.buffer->buffer_state ==
-        SumReadBuffer::SumReadBufferState::Invalid) {
-        return {nullptr, nullptr};
-    }
-
-    SumReadBuffer *buffer = this->buffer_reader.buffer;
-    RWLock *rwlock = &buffer->rwlock;
-    rwlock->lock_read();
-    uint8_t *data = buffer->get_buffer_data_section();
-    data += this->buffer_reader.off_data;
-
-    return {data, rwlock};
-}
-
 int ADSVariable::write(const char *data, const uint32_t size) {
     if (data == nullptr) {
         return EPICSADS_INV_PARAM;
@@ -155,13 +238,17 @@ int ADSVariable::write(const char *data, const uint32_t size) {
         return ads_rc_to_epicsads_error(rc);
     }
 
-    if (write_readback) {
-        last_written = buffer;
-    }
+    this->set_written(buffer);
 
     return 0;
 }
 
+void ADSVariable::set_written(const std::vector<uint8_t> &data) {
+    if (write_readback) {
+        last_written = data;
+    }
+}
+
 int ADSVariable::read(uint8_t *data, const uint32_t size,
                       uint32_t *bytes_read) {
     if (data == nullptr) {
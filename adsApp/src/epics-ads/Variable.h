@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 #include <ADSAddress.h>
 #include <BufferDataPosition.h>
@@ -22,10 +24,22 @@ class ADSVariable {
     std::shared_ptr<Connection> conn = nullptr;
     BufferDataPosition buffer_reader = EMPTY_BUFFER_DATA_POSITION;
     uint32_t elem_size = 0; /* Element size in bytes */
-    std::vector<uint8_t> value;
-    int array_data_hash; // Used to detect change on read
+    std::vector<uint8_t> value; /* Latest value received by notification */
+    bool value_valid = false;
+    std::atomic<bool> value_updated;
+    std::mutex value_mtx; /* Protects `value` and `value_valid` */
+    uint32_t notification_handle = 0; /* ADS device notification handle */
+    uint32_t notification_user = 0;   /* hUser passed with the notification */
     bool write_readback = false;
     std::vector<uint8_t> last_written;
+    /* Variable whose sum-read data is returned by read_from_buffer(), if the
+     * same symbol is already read for another record, or if this variable is
+     * an element of a variable read as a whole */
+    std::shared_ptr<ADSVariable> read_source = nullptr;
+    uint32_t read_source_offset = 0; /* Byte offset within read_source */
+
+    /* Read SIZE bytes at byte OFFSET of the variable's latest data */
+    int read_data(const uint32_t offset, const uint32_t size, char *buffer);
 
   public:
     const std::shared_ptr<ADSAddress> addr;
@@ -34,8 +48,11 @@ class ADSVariable {
     bool uses_write_readback();
     void set_write_readback(const bool readback);
 
-    // Updates the stored data hash and returns true if it has changed.
-    bool updateDataHash(int new_hash);
+    /* Read the data of SOURCE at byte OFFSET instead of reading this variable
+     * in sum-reads. Used for write readback of symbols that are also read by
+     * other records, and for elements of a variable read as a whole. */
+    void set_read_source(std::shared_ptr<ADSVariable> source,
+                         const uint32_t offset = 0);
 
     void set_connection(std::shared_ptr<Connection> connection);
     std::shared_ptr<Connection> get_connection();
@@ -45,21 +62,51 @@ class ADSVariable {
     void set_buffer_reader(BufferDataPosition br);
     BufferDataPosition get_buffer_reader();
 
+    /* True if the variable's value or read result changed in the latest
+     * sum-read, or if a written value is waiting to be read back. For
+     * variables read by ADS device notifications, true if a notification was
+     * received since the previous call. */
+    bool is_updated();
+
+    /* True if the variable's value or read result changed in the latest
+     * sum-read, i.e. the part of is_updated() that only depends on the
+     * sum-read buffer. */
+    bool is_read_updated();
+
+    /* True if a written value is waiting to be read back */
+    bool readback_pending();
+
+    /* True if the variable is read by ADS device notifications instead of
+     * sum-reads, i.e. a read variable with a notification delay. */
+    bool uses_notification();
+
+    /* Store handle and hUser of the ADS device notification registered for
+     * the variable, or zeros after the notification is deleted. */
+    void set_notification(const uint32_t handle, const uint32_t user);
+    uint32_t get_notification_handle();
+    uint32_t get_notification_user();
+
+    /* Store value of SIZE bytes received by ADS device notification */
+    void store_notification_value(const uint8_t *data, const uint32_t size);
+
+    /* Mark the value received by notification as invalid, e.g. on
+     * disconnect. */
+    void invalidate_value();
+
     ADSVariable(std::shared_ptr<ADSAddress> address);
 
-    /* Read data from underlying buffer. The method implicitly acquires a read
-     * lock before copying into the caller's buffer.  */
+    /* Read data from underlying buffer into the caller's buffer. For
+     * variables read by notifications, the latest notified value is read. */
     int read_from_buffer(const uint32_t size, char *buffer);
 
-    /* Get pointer to the underlying value as uint8_t. The method implicitly
-     * acquires a read lock (RWLock), which *must* be released by the caller
-     * when done reading the data. */
-    std::pair<uint8_t *, RWLock *> get_read_data();
-
     /* Write DATA to ADS device. The number of bytes written will be set to the
      * smaller of SIZE and this->size() values. */
     int write(const char *data, const uint32_t size);
 
+    /* Record DATA as written to the ADS device, so that it is returned by the
+     * next read_from_buffer() if write readback is used. */
+    void set_written(const std::vector<uint8_t> &data);
+
     /* Read variable from ADS device into DATA or SIZE bytes. The number of
      * bytes read will be the smaller value of SIZE and this->size().  */
     int read(uint8_t *data, const uint32_t size, uint32_t *bytes_read);
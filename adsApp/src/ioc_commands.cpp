@@ -24,6 +24,23 @@ static const iocshArg *ads_set_ams_args[] = {&ads_set_ams_arg};
 static const iocshFuncDef ads_set_local_amsNetID_func_def = {
     "AdsSetLocalAMSNetID", 1, ads_set_ams_args};
 
+static const iocshArg ads_set_option_arg0 = {"port_name", iocshArgString};
+static const iocshArg ads_set_option_arg1 = {"option", iocshArgString};
+static const iocshArg ads_set_option_arg2 = {"value", iocshArgString};
+static const iocshArg *ads_set_option_args[] = {
+    &ads_set_option_arg0, &ads_set_option_arg1, &ads_set_option_arg2};
+static const iocshFuncDef ads_set_option_func_def = {"AdsSetOption", 3,
+                                                     ads_set_option_args};
+
+static const iocshArg ads_set_scan_class_arg0 = {"port_name", iocshArgString};
+static const iocshArg ads_set_scan_class_arg1 = {"scan_class", iocshArgInt};
+static const iocshArg ads_set_scan_class_arg2 = {"period_ms", iocshArgInt};
+static const iocshArg *ads_set_scan_class_args[] = {
+    &ads_set_scan_class_arg0, &ads_set_scan_class_arg1,
+    &ads_set_scan_class_arg2};
+static const iocshFuncDef ads_set_scan_class_func_def = {
+    "AdsSetScanClass", 3, ads_set_scan_class_args};
+
 epicsShareFunc int ads_open(int argc, const char *const *argv) {
     std::string port_name;
     std::string ip_addr;
@@ -33,13 +50,16 @@ epicsShareFunc int ads_open(int argc, const char *const *argv) {
     int ads_function_timeout_ms = -1;
     int sum_read_period = defaultSumReadPeriod.count();
     std::chrono::milliseconds chr_sum_read_period{ sum_read_period };
+    int sum_read_parallelism = defaultSumReadParallelism;
 
-    if (argc < 3 || argc > 8) {
+    if (argc < 3 || argc > 9) {
         errlogPrintf(
             "AdsOpen <port_name> <ip_addr> <ams_net_id>"
             " | optional: <sum_buffer_nelem (default: %u)> <ads_timeout "
-            "(default: %u) [ms]> <device_read_ads_port (default: %u)> <sum_read_period (default: %ld)>\n",
-            defaultSumBuferNelem, defaultADSCallTimeout_ms, defaultDeviceReadADSPort, defaultSumReadPeriod.count());
+            "(default: %u) [ms]> <device_read_ads_port (default: %u)> <sum_read_period (default: %ld)>"
+            " <sum_read_parallelism (default: %u)>\n",
+            defaultSumBuferNelem, defaultADSCallTimeout_ms, defaultDeviceReadADSPort, defaultSumReadPeriod.count(),
+            defaultSumReadParallelism);
         return -1;
     }
 
@@ -91,13 +111,24 @@ epicsShareFunc int ads_open(int argc, const char *const *argv) {
                 return -1;
             }
             chr_sum_read_period = std::chrono::milliseconds(sum_read_period);
+            break;
+        case 8:
+            sum_read_parallelism = strtol(argv[i], nullptr, 10);
+            if (sum_read_parallelism < 1) {
+                errlogPrintf(
+                    "Error: sum_read_parallelism must be a positive integer (%i)\n",
+                    sum_read_parallelism);
+                return -1;
+            }
+            break;
         default:
             break;
         }
     }
 
     new ADSPortDriver(port_name.c_str(), ip_addr.c_str(), ams_net_id.c_str(),
-                      sum_buffer_nelem, ads_function_timeout_ms, device_read_ads_port, chr_sum_read_period);
+                      sum_buffer_nelem, ads_function_timeout_ms, device_read_ads_port, chr_sum_read_period,
+                      sum_read_parallelism);
 
     return 0;
 }
@@ -113,6 +144,54 @@ epicsShareFunc void ads_set_local_amsNetID(const char *ams) {
     return;
 }
 
+epicsShareFunc int ads_set_option(const char *port_name, const char *option,
+                                  const char *value) {
+    if (port_name == NULL || option == NULL || value == NULL) {
+        errlogPrintf("AdsSetOption <port_name> <option> <value>\n");
+        return -1;
+    }
+
+    ADSPortDriver *driver = dynamic_cast<ADSPortDriver *>(
+        static_cast<asynPortDriver *>(findAsynPortDriver(port_name)));
+    if (driver == nullptr) {
+        errlogPrintf("Error: ADS port '%s' not found\n", port_name);
+        return -1;
+    }
+
+    if (driver->setOption(option, value) != asynSuccess) {
+        errlogPrintf("Error: could not set option '%s' to '%s'\n", option,
+                     value);
+        return -1;
+    }
+
+    return 0;
+}
+
+epicsShareFunc int ads_set_scan_class(const char *port_name, int scan_class,
+                                      int period_ms) {
+    if (port_name == NULL || scan_class < 0 || period_ms <= 0) {
+        errlogPrintf("AdsSetScanClass <port_name> <scan_class> <period_ms>\n");
+        return -1;
+    }
+
+    ADSPortDriver *driver = dynamic_cast<ADSPortDriver *>(
+        static_cast<asynPortDriver *>(findAsynPortDriver(port_name)));
+    if (driver == nullptr) {
+        errlogPrintf("Error: ADS port '%s' not found\n", port_name);
+        return -1;
+    }
+
+    if (driver->setScanClass(scan_class,
+                             std::chrono::milliseconds(period_ms)) !=
+        asynSuccess) {
+        errlogPrintf("Error: could not set period of scan class %d\n",
+                     scan_class);
+        return -1;
+    }
+
+    return 0;
+}
+
 static void ads_open_call_func(const iocshArgBuf *args) {
     ads_open(args[0].aval.ac, args[0].aval.av);
 }
@@ -121,6 +200,14 @@ static void ads_set_local_amsNetID_call_func(const iocshArgBuf *args) {
     ads_set_local_amsNetID(args[0].sval);
 }
 
+static void ads_set_option_call_func(const iocshArgBuf *args) {
+    ads_set_option(args[0].sval, args[1].sval, args[2].sval);
+}
+
+static void ads_set_scan_class_call_func(const iocshArgBuf *args) {
+    ads_set_scan_class(args[0].sval, args[1].ival, args[2].ival);
+}
+
 static void ads_open_register_command(void) {
     static int already_registered = 0;
 
@@ -140,7 +227,28 @@ static void ads_set_local_amsNetID_register_command(void) {
     }
 }
 
+static void ads_set_option_register_command(void) {
+    static int already_registered = 0;
+
+    if (already_registered == 0) {
+        iocshRegister(&ads_set_option_func_def, ads_set_option_call_func);
+        already_registered = 1;
+    }
+}
+
+static void ads_set_scan_class_register_command(void) {
+    static int already_registered = 0;
+
+    if (already_registered == 0) {
+        iocshRegister(&ads_set_scan_class_func_def,
+                      ads_set_scan_class_call_func);
+        already_registered = 1;
+    }
+}
+
 extern "C" {
 epicsExportRegistrar(ads_open_register_command);
 epicsExportRegistrar(ads_set_local_amsNetID_register_command);
+epicsExportRegistrar(ads_set_option_register_command);
+epicsExportRegistrar(ads_set_scan_class_register_command);
 }
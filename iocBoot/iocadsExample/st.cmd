@@ -38,7 +38,8 @@ dbLoadRecords("db/example.db","P=$(PREFIX_ADSEXAMPLE), PORT=$(PORT_ADSEXAMPLE)")
 #         sum_buffer_nelem (default: 500),
 #         ads_timeout (default: 500 ms),
 #         device_ads_port (default: 851),
-#         sum_read_period (default: 1 ms))
+#         sum_read_period (default: 1 ms),
+#         sum_read_parallelism (default: 1))
 AdsOpen("$(PORT_ADSEXAMPLE)", "$(IP_ADSEXAMPLE)", "$(AMS_ID_ADSEXAMPLE)")
 
 # Enable asyn trace output for errors and warnings